@@ -0,0 +1,59 @@
+# Compares the minimal and full mbedTLS builds: static library size, link time of moonbasepp-bench, and decode / verify latency.
+# Usage: cmake -DTOKEN=<license-token.mb> -DKEY=<public key> [-DITERATIONS=10000] [-DBUILD_ROOT=<dir>] [-DCONFIG=Release] -P benchmarks/compare_mbedtls_profiles.cmake
+cmake_minimum_required(VERSION 3.23) # string(TIMESTAMP) %f
+
+if (NOT TOKEN OR NOT KEY)
+    message(FATAL_ERROR "Usage: cmake -DTOKEN=<license-token.mb> -DKEY=<public key> [-DITERATIONS=10000] [-DBUILD_ROOT=<dir>] [-DCONFIG=Release] -P ${CMAKE_CURRENT_LIST_FILE}")
+endif ()
+if (NOT ITERATIONS)
+    set(ITERATIONS 10000)
+endif ()
+if (NOT CONFIG)
+    set(CONFIG Release)
+endif ()
+get_filename_component(sourceDir "${CMAKE_CURRENT_LIST_DIR}/.." ABSOLUTE)
+if (NOT BUILD_ROOT)
+    set(BUILD_ROOT "${sourceDir}/_profile_builds")
+endif ()
+
+function(now_in_ms outVar)
+    # One call, so the seconds & microseconds can't straddle a tick - %f is zero padded to 6 digits
+    string(TIMESTAMP micros "%s%f" UTC)
+    math(EXPR ms "${micros} / 1000")
+    set(${outVar} ${ms} PARENT_SCOPE)
+endfunction()
+
+set(report "")
+foreach (profile ON OFF)
+    set(buildDir "${BUILD_ROOT}/minimal-${profile}")
+    execute_process(COMMAND ${CMAKE_COMMAND} -S "${sourceDir}" -B "${buildDir}" -DCMAKE_BUILD_TYPE=${CONFIG}
+            -DMOONBASEPP_MINIMAL_MBEDTLS=${profile} -DMOONBASEPP_BUILD_BENCHMARKS=ON
+            COMMAND_ERROR_IS_FATAL ANY)
+    execute_process(COMMAND ${CMAKE_COMMAND} --build "${buildDir}" --config ${CONFIG} --target moonbasepp-bench COMMAND_ERROR_IS_FATAL ANY)
+
+    # Link time - remove the executable, and time relinking it with everything else up to date
+    file(GLOB_RECURSE executables "${buildDir}/moonbasepp-bench" "${buildDir}/moonbasepp-bench.exe")
+    file(REMOVE ${executables})
+    now_in_ms(linkStart)
+    execute_process(COMMAND ${CMAKE_COMMAND} --build "${buildDir}" --config ${CONFIG} --target moonbasepp-bench COMMAND_ERROR_IS_FATAL ANY)
+    now_in_ms(linkEnd)
+    math(EXPR linkMs "${linkEnd} - ${linkStart}")
+
+    # The mbedTLS archives we link - just mbedcrypto for the minimal profile, all three otherwise
+    if (profile)
+        file(GLOB_RECURSE archives "${buildDir}/*mbedcrypto.a" "${buildDir}/*mbedcrypto.lib")
+    else ()
+        file(GLOB_RECURSE archives "${buildDir}/*mbedcrypto.a" "${buildDir}/*mbedcrypto.lib" "${buildDir}/*mbedx509.a" "${buildDir}/*mbedx509.lib" "${buildDir}/*mbedtls.a" "${buildDir}/*mbedtls.lib")
+    endif ()
+    set(archiveBytes 0)
+    foreach (archive ${archives})
+        file(SIZE "${archive}" size)
+        math(EXPR archiveBytes "${archiveBytes} + ${size}")
+    endforeach ()
+
+    file(GLOB_RECURSE executables "${buildDir}/moonbasepp-bench" "${buildDir}/moonbasepp-bench.exe")
+    list(GET executables 0 executable)
+    execute_process(COMMAND "${executable}" "${TOKEN}" "${KEY}" ${ITERATIONS} OUTPUT_VARIABLE benchOutput COMMAND_ERROR_IS_FATAL ANY)
+    string(APPEND report "\nMOONBASEPP_MINIMAL_MBEDTLS=${profile}\n  mbedTLS archives: ${archiveBytes} bytes\n  bench relink:     ${linkMs} ms\n${benchOutput}")
+endforeach ()
+message(STATUS "${report}")
@@ -0,0 +1,61 @@
+//
+// Times jwt::decode + jwt::verifySignature against a real token, for comparing mbedTLS configs.
+// Usage: moonbasepp-bench <license-token.mb> <public key, PEM or DER> [iterations]
+//
+
+#include <moonbasepp/moonbasepp_JWT.h>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <span>
+#include <string>
+
+static auto readFile(const char* path) -> std::string {
+    std::ifstream inStream{ path, std::ios::in | std::ios::binary };
+    return { std::istreambuf_iterator<char>(inStream), std::istreambuf_iterator<char>() };
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3) {
+        std::cerr << "Usage: moonbasepp-bench <license-token.mb> <public key, PEM or DER> [iterations]\n";
+        return 1;
+    }
+    const auto token = readFile(argv[1]);
+    const auto key = readFile(argv[2]);
+    const auto iterations = argc > 3 ? std::stoi(argv[3]) : 10000;
+    const auto isPem = key.starts_with("-----BEGIN");
+    const std::span<const unsigned char> keyDer{ reinterpret_cast<const unsigned char*>(key.data()), key.size() };
+    const auto verify = [&](const moonbasepp::jwt::JWT& jwt) -> bool {
+        return isPem ? moonbasepp::jwt::verifySignature(key, jwt) : moonbasepp::jwt::verifySignature(keyDer, jwt);
+    };
+
+    const auto decoded = moonbasepp::jwt::decode(token);
+    if (!decoded || !verify(*decoded)) {
+        std::cerr << "Token failed to decode or verify against the supplied key\n";
+        return 1;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto decodeTime = Clock::duration::zero();
+    auto verifyTime = Clock::duration::zero();
+    auto numFailures{ 0 };
+    for (auto i = 0; i < iterations; ++i) {
+        const auto start = Clock::now();
+        const auto jwt = moonbasepp::jwt::decode(token);
+        const auto decodedAt = Clock::now();
+        if (!jwt || !verify(*jwt)) {
+            ++numFailures;
+        }
+        decodeTime += decodedAt - start;
+        verifyTime += Clock::now() - decodedAt;
+    }
+    const auto toMicros = [iterations](Clock::duration d) -> double {
+        return std::chrono::duration<double, std::micro>(d).count() / iterations;
+    };
+    std::cout << "iterations: " << iterations << " (" << (isPem ? "PEM" : "DER") << " key)\n"
+              << "decode:     " << toMicros(decodeTime) << " us/op\n"
+              << "verify:     " << toMicros(verifyTime) << " us/op\n"
+              << "total:      " << toMicros(decodeTime + verifyTime) << " us/op\n";
+    return numFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,84 @@
+# moonbasepp_embed_public_key(<target> KEY_FILE <pem-file> [NAMESPACE <ns>] [VARIABLE <name>] [HEADER <file-name>])
+#
+# Converts the PEM public key from your moonbase product page to DER at configure time, and generates a header
+# containing it as a `constexpr std::array<unsigned char, N>`, which is added to <target>'s include path.
+# Pass the array to `Licensing::Context::publicKeyDer` (or `jwt::verifySignature` directly) to skip PEM parsing at runtime.
+#
+# Defaults: NAMESPACE moonbasepp::keys, VARIABLE publicKeyDer, HEADER moonbasepp_PublicKey.h
+function(moonbasepp_embed_public_key target)
+    cmake_parse_arguments(MBPK "" "KEY_FILE;NAMESPACE;VARIABLE;HEADER" "" ${ARGN})
+    if (NOT MBPK_KEY_FILE)
+        message(FATAL_ERROR "moonbasepp_embed_public_key: KEY_FILE is required")
+    endif ()
+    if (NOT MBPK_NAMESPACE)
+        set(MBPK_NAMESPACE "moonbasepp::keys")
+    endif ()
+    if (NOT MBPK_VARIABLE)
+        set(MBPK_VARIABLE "publicKeyDer")
+    endif ()
+    if (NOT MBPK_HEADER)
+        set(MBPK_HEADER "moonbasepp_PublicKey.h")
+    endif ()
+    get_filename_component(keyFile "${MBPK_KEY_FILE}" ABSOLUTE)
+    if (NOT EXISTS "${keyFile}")
+        message(FATAL_ERROR "moonbasepp_embed_public_key: ${keyFile} does not exist")
+    endif ()
+    # Re-run configure if the key changes.
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS "${keyFile}")
+
+    file(READ "${keyFile}" pem)
+    string(REGEX REPLACE "-----[^-]*-----" "" b64 "${pem}")
+    string(REGEX REPLACE "[ \t\r\n=]" "" b64 "${b64}")
+    string(LENGTH "${b64}" b64Length)
+    if (b64Length EQUAL 0)
+        message(FATAL_ERROR "moonbasepp_embed_public_key: ${keyFile} doesn't contain a PEM encoded key")
+    endif ()
+
+    # CMake has no base64 decoder, so do it by hand - keys are a few hundred bytes, so this is cheap enough.
+    set(alphabet "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/")
+    set(accumulator 0)
+    set(numBits 0)
+    set(numBytes 0)
+    set(bytes "")
+    math(EXPR lastIndex "${b64Length} - 1")
+    foreach (i RANGE 0 ${lastIndex})
+        string(SUBSTRING "${b64}" ${i} 1 char)
+        string(FIND "${alphabet}" "${char}" value)
+        if (value EQUAL -1)
+            message(FATAL_ERROR "moonbasepp_embed_public_key: invalid base64 character '${char}' in ${keyFile}")
+        endif ()
+        math(EXPR accumulator "((${accumulator} << 6) | ${value}) & 0xFFFFFF")
+        math(EXPR numBits "${numBits} + 6")
+        if (numBits GREATER 7)
+            math(EXPR numBits "${numBits} - 8")
+            math(EXPR byte "(${accumulator} >> ${numBits}) & 0xFF")
+            math(EXPR column "${numBytes} % 16")
+            if (column EQUAL 0)
+                string(APPEND bytes "\n        ")
+            else ()
+                string(APPEND bytes " ")
+            endif ()
+            string(APPEND bytes "${byte},")
+            math(EXPR numBytes "${numBytes} + 1")
+        endif ()
+    endforeach ()
+
+    string(MAKE_C_IDENTIFIER "${MBPK_HEADER}" guard)
+    string(TOUPPER "${guard}" guard)
+    get_filename_component(keyFileName "${keyFile}" NAME)
+    set(outputDir "${CMAKE_CURRENT_BINARY_DIR}/moonbasepp_generated/${target}")
+    file(WRITE "${outputDir}/${MBPK_HEADER}.tmp"
+            "// Generated by moonbasepp_embed_public_key from ${keyFileName} - do not edit.\n"
+            "#ifndef ${guard}\n"
+            "#define ${guard}\n"
+            "#include <array>\n"
+            "namespace ${MBPK_NAMESPACE} {\n"
+            "    constexpr std::array<unsigned char, ${numBytes}> ${MBPK_VARIABLE}{${bytes}\n"
+            "    };\n"
+            "} // namespace ${MBPK_NAMESPACE}\n"
+            "#endif // ${guard}\n"
+    )
+    # Only touch the real header if the contents changed, so reconfiguring doesn't trigger a rebuild.
+    configure_file("${outputDir}/${MBPK_HEADER}.tmp" "${outputDir}/${MBPK_HEADER}" COPYONLY)
+    target_include_directories(${target} PRIVATE "${outputDir}")
+endfunction()
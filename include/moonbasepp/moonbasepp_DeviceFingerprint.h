@@ -6,6 +6,7 @@
 #define MOONBASEPP_DEVICEFINGERPRINT_H
 
 #include <cstdint>
+#include <optional>
 #include <string>
 
 namespace moonbasepp {
@@ -19,5 +20,7 @@ namespace moonbasepp {
     };
     auto getFingerprint() -> DeviceFingerprint;
     auto compareFingerprint(const DeviceFingerprint& cachedFingerprint, std::string base64ToCompare) -> bool;
+    /// Reconstructs the hashes of a fingerprint from its base64 form (eg a license token's "sig" claim) - deviceName will be empty
+    auto fingerprintFromBase64(const std::string& base64) -> std::optional<DeviceFingerprint>;
 } // namespace moonbasepp
 #endif // MOONBASEPP_DEVICEFINGERPRINT_H
@@ -5,8 +5,10 @@
 #ifndef MOONBASEPP_JWT_H
 #define MOONBASEPP_JWT_H
 
+#include "moonbasepp_JWTPublicKey.h"
 #include "nlohmann/json.hpp"
 #include <optional>
+#include <span>
 
 
 #include <string_view>
@@ -20,7 +22,10 @@ namespace moonbasepp::jwt {
     };
 
     auto decode(std::string_view encoded) -> std::optional<JWT>;
+    auto verifySignature(PublicKey& publicKey, const JWT& toVerify) -> bool;
     auto verifySignature(const std::string& publicKey, const JWT& toVerify) -> bool;
+    /// As above, but takes a DER encoded public key (see `moonbasepp_embed_public_key` in CMake), skipping PEM decoding entirely.
+    auto verifySignature(std::span<const unsigned char> publicKeyDer, const JWT& toVerify) -> bool;
 
 } // namespace moonbasepp::jwt
 #endif // MOONBASEPP_JWT_H
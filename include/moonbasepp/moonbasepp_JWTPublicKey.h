@@ -0,0 +1,32 @@
+#ifndef MOONBASEPP_JWTPUBLICKEY_H
+#define MOONBASEPP_JWTPUBLICKEY_H
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+// Deliberately JSON free, so headers that only need to pass keys around (eg moonbasepp_LicenseVault.h) don't pull in nlohmann
+namespace moonbasepp::jwt {
+    struct JWT;
+
+    /**
+     * A parsed public key, for verifying many tokens without re-parsing the key each time.
+     * Verifying may update the key's internal caches, so don't share an instance between threads - give each thread its own.
+     */
+    class PublicKey final {
+    public:
+        PublicKey(PublicKey&& other) noexcept;
+        auto operator=(PublicKey&& other) noexcept -> PublicKey&;
+        ~PublicKey() noexcept;
+        /// Parses a PEM encoded public key, as provided on your moonbase product page
+        [[nodiscard]] static auto fromPem(const std::string& pem) -> std::optional<PublicKey>;
+        /// Parses a DER encoded public key (see `moonbasepp_embed_public_key` in CMake)
+        [[nodiscard]] static auto fromDer(std::span<const unsigned char> der) -> std::optional<PublicKey>;
+
+    private:
+        PublicKey();
+        friend auto verifySignature(PublicKey& publicKey, const JWT& toVerify) -> bool;
+        struct Impl;
+        std::unique_ptr<Impl> m_impl;
+    };
+} // namespace moonbasepp::jwt
+#endif // MOONBASEPP_JWTPUBLICKEY_H
@@ -0,0 +1,93 @@
+#ifndef MOONBASEPP_LICENSEVAULT_H
+#define MOONBASEPP_LICENSEVAULT_H
+#include "moonbasepp_JWTPublicKey.h"
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+namespace moonbasepp {
+    /**
+     * A single file holding license tokens for many products & devices, for shared machines that would otherwise end up with
+     * a license-token.mb per product per user.
+     * The file is a fixed-layout header, followed by an index sorted by (productId, device signature), followed by the raw tokens.
+     * Each index entry also holds the claims needed to work out a license's status, so lookups are a binary search over the
+     * memory-mapped file, with no JSON or base64 parsing.
+     * Writes are copy-on-write - a new file is written alongside the vault, flushed to disk, and atomically renamed over it, so readers
+     * (in this or any other process) never see a partially written vault. Writers hold an exclusive lock on `<vault file>.lock` from
+     * reading the current vault until the new one is in place, so concurrent stores & removes - from any process - wait for each other
+     * rather than dropping each other's entries.
+     */
+    class LicenseVault final {
+    public:
+        /**
+         * trial, offline, expiresAt & validatedAt are copied out of the token when it's stored, and aren't authenticated on read -
+         * anyone who can write the vault file can change them. They're fine for listing & display, but before using an entry to make
+         * a licensing decision, re-verify `token` (eg via jwt::decode & jwt::verifySignature), and use the claims from that.
+         */
+        struct Entry final {
+            /// The "p:id" claim
+            std::string_view productId;
+            /// The "sig" claim - the device signature the token was issued to
+            std::string_view deviceSignature;
+            /// The raw license token, exactly as it would be written to license-token.mb
+            std::string_view token;
+            /// The "trial" claim
+            bool trial;
+            /// True if the token was activated offline
+            bool offline;
+            /// The "exp" claim in seconds since epoch, or 0 if the token doesn't have one
+            std::int64_t expiresAt;
+            /// The "validated" claim in seconds since epoch, or 0 if the token doesn't have one
+            std::int64_t validatedAt;
+            /// Keeps the mapping the views above point into alive, even if the vault is reloaded or rewritten
+            std::shared_ptr<const void> storage;
+        };
+
+        /// Maps vaultFile if it exists - if it doesn't, the vault starts empty, and the file is created on the first store
+        explicit LicenseVault(std::filesystem::path vaultFile);
+        ~LicenseVault() noexcept;
+
+        /**
+         * [[ Any Thread ]]
+         * Re-maps the vault file, to pick up writes made by other processes.
+         * @return false if the file exists but isn't a valid vault - in that case the previous mapping is kept
+         */
+        [[nodiscard]] auto reload() -> bool;
+        // [[ Any Thread ]] O(log n) lookup by exact product id & device signature
+        [[nodiscard]] auto find(std::string_view productId, std::string_view deviceSignature) const -> std::optional<Entry>;
+        // [[ Any Thread ]]
+        [[nodiscard]] auto size() const -> std::size_t;
+
+        /**
+         * [[ Background Thread ]]
+         * Verifies a license token, and adds it to the vault, replacing any existing token for the same product & device.
+         * @param token The license token, as received from moonbase
+         * @param publicKey The key to verify the token against
+         * @return false if the token is invalid, or the vault couldn't be written
+         */
+        [[nodiscard]] auto store(std::string_view token, jwt::PublicKey& publicKey) -> bool;
+        // [[ Background Thread ]] Returns false if there was no such entry, or the vault couldn't be written
+        [[nodiscard]] auto remove(std::string_view productId, std::string_view deviceSignature) -> bool;
+
+    private:
+        struct Mapping;
+        struct Record;
+        [[nodiscard]] static auto mapFile(const std::filesystem::path& path) -> std::unique_ptr<Mapping>;
+        [[nodiscard]] static auto readEntry(const Mapping& mapping, std::uint32_t index) -> std::optional<Entry>;
+        [[nodiscard]] static auto readRecords(const Mapping* mapping) -> std::optional<std::vector<Record>>;
+        [[nodiscard]] auto readLatestRecords() const -> std::optional<std::vector<Record>>;
+        [[nodiscard]] auto getMapping() const -> std::shared_ptr<const Mapping>;
+        [[nodiscard]] auto getLockFile() const -> std::filesystem::path;
+        auto write(const std::vector<Record>& records) -> bool;
+
+        std::filesystem::path m_vaultFile;
+        mutable std::mutex m_mappingMutex;
+        std::shared_ptr<const Mapping> m_mapping;
+        std::mutex m_writeMutex;
+    };
+} // namespace moonbasepp
+#endif // MOONBASEPP_LICENSEVAULT_H
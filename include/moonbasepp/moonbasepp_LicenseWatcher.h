@@ -0,0 +1,88 @@
+#ifndef MOONBASEPP_LICENSEWATCHER_H
+#define MOONBASEPP_LICENSEWATCHER_H
+#include "moonbasepp_Licensing.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+namespace moonbasepp {
+    /**
+     * Opt-in watcher for a Licensing instance's license file - construct one if you want offline license tokens dropped into
+     * `Context::expectedLicenseLocation` to be picked up without the user needing to do anything.
+     * Owns a single background thread, which blocks on the platform's native change notifications - inotify on Linux, kqueue on macOS,
+     * and ReadDirectoryChangesW on Windows - so it costs nothing while idle, and picks changes up as soon as they've settled. If the
+     * native watch can't be set up (or on any other platform), it falls back to checking the file's size & modification time every
+     * pollInterval. If the watched directory is deleted or moved, the watch is re-established once it exists again.
+     * Bursts of writes are debounced, and once the file has settled (and its contents have actually changed), `Licensing::checkForExisting` is
+     * called, and the resulting status is published to all subscribers.
+     * The Licensing instance must outlive the watcher.
+     */
+    class LicenseWatcher final {
+    public:
+        using Listener = std::function<void(const Licensing::LicenseStatus&)>;
+
+        /**
+         * @param licensing The Licensing instance to re-check on change
+         * @param debounceTime How long the license file must go without changes before it gets checked
+         * @param pollInterval How often to check the license file if native change notifications aren't available, and how often to
+         * look for the license directory if it's been deleted
+         */
+        explicit LicenseWatcher(Licensing& licensing,
+                                std::chrono::milliseconds debounceTime = std::chrono::milliseconds{ 250 },
+                                std::chrono::milliseconds pollInterval = std::chrono::seconds{ 1 });
+        ~LicenseWatcher() noexcept;
+        LicenseWatcher(const LicenseWatcher&) = delete;
+        LicenseWatcher& operator=(const LicenseWatcher&) = delete;
+
+        /**
+         * [[ Any Thread ]]
+         * Registers a listener, invoked from the watcher thread with the new status each time the license file changes.
+         * @return An id to pass to unsubscribe
+         */
+        [[nodiscard]] auto subscribe(Listener listener) -> int;
+        // [[ Any Thread ]] - once this returns, the listener will not be invoked again. Don't call this (or subscribe) from inside a listener
+        auto unsubscribe(int id) -> void;
+
+    private:
+        struct FileState final {
+            bool exists{ false };
+            std::uintmax_t size{ 0 };
+            std::filesystem::file_time_type lastWriteTime{};
+            auto operator==(const FileState&) const -> bool = default;
+        };
+
+        // [[ Watcher Thread ]]
+        auto run() -> void;
+        auto runPolling() -> void;
+        auto waitFor(std::chrono::milliseconds duration) -> bool;
+        auto readLicenseFile() const -> std::string;
+        auto getLicenseFileState() const -> FileState;
+        auto onLicenseFileChanged() -> void;
+
+        Licensing& m_licensing;
+        std::chrono::milliseconds m_debounceTime;
+        std::chrono::milliseconds m_pollInterval;
+        std::string m_lastSeenToken;
+        FileState m_lastSeenState;
+        std::mutex m_listenerMutex;
+        std::unordered_map<int, Listener> m_listeners;
+        int m_nextListenerId{ 0 };
+        std::mutex m_stopMutex;
+        std::condition_variable m_stopCv;
+        std::atomic<bool> m_stop{ false };
+#if defined(_WIN32)
+        /// Manual reset event used to wake the ReadDirectoryChangesW loop on shutdown
+        void* m_wakeEvent{ nullptr };
+#else
+        /// Used to wake the watcher thread on shutdown - an eventfd on Linux, and the kqueue itself (via EVFILT_USER) on macOS
+        int m_wakeFd{ -1 };
+#endif
+        std::thread m_thread;
+    };
+} // namespace moonbasepp
+#endif // MOONBASEPP_LICENSEWATCHER_H
@@ -5,7 +5,13 @@
 #ifndef MOONBASEPP_LICENSING_H
 #define MOONBASEPP_LICENSING_H
 #include "moonbasepp_DeviceFingerprint.h"
+#include <atomic>
+#include <chrono>
 #include <filesystem>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <span>
 namespace moonbasepp {
     /**
      * Expected usage::
@@ -25,6 +31,14 @@ namespace moonbasepp {
             std::optional<int> gracePeriod; // eg 30
         };
 
+        /// The outcome of applying ValidationThresholds to a token's last validation time - see getValidationDecision
+        struct ValidationDecision final {
+            /// If false, the token was validated recently enough that online validation shouldn't be attempted
+            bool shouldValidate;
+            /// Whether the license should still be reported as active if online validation is attempted and fails
+            bool activeIfValidationFails;
+        };
+
         struct Context final {
             /// The moonbase product id for this product, eg "my-plugin"
             std::string_view productId;
@@ -35,6 +49,10 @@ namespace moonbasepp {
             /// Path to the location you want your license to be stored at
             std::filesystem::path expectedLicenseLocation;
             ValidationThresholds validationThresholds;
+            /// Optional time source, for driving the validation / trial logic in tests and simulations. If empty, std::chrono::system_clock::now() is used
+            std::function<std::chrono::system_clock::time_point()> clock{};
+            /// Optional DER encoded copy of publicKey, eg generated via `moonbasepp_embed_public_key` in CMake. If non-empty, this is used instead of publicKey
+            std::span<const unsigned char> publicKeyDer{};
         };
 
         enum class ActivationResult {
@@ -94,13 +112,30 @@ namespace moonbasepp {
         [[nodiscard]] auto receiveOfflineLicenseToken(const std::string& data) -> bool;
         // [[ Any Thread ]]
         [[nodiscard]] auto getLicenseStatus() const -> LicenseStatus;
+        // [[ Any Thread ]] - the license file within Context::expectedLicenseLocation
+        [[nodiscard]] auto getLicenseFile() const -> const std::filesystem::path&;
+
+        /**
+         * [[ Any Thread ]]
+         * The validation policy used by checkForExisting for online-activated licenses, exposed so the thresholds can be sized offline.
+         * @param thresholds The thresholds to apply
+         * @param lastValidated When the license token was last validated (its "validated" claim)
+         * @param now The current time
+         */
+        [[nodiscard]] static auto getValidationDecision(const ValidationThresholds& thresholds,
+                                                        std::chrono::system_clock::time_point lastValidated,
+                                                        std::chrono::system_clock::time_point now) -> ValidationDecision;
 
     private:
-        // [[ Background Thread ]]
+        // [[ Background Thread ]] - callers must hold m_licenseFileMutex
         auto check(const std::filesystem::path& toCheck) -> bool;
+        // [[ Any Thread ]]
+        [[nodiscard]] auto now() const -> std::chrono::system_clock::time_point;
         Context m_context;
         DeviceFingerprint m_fingerprint;
         std::filesystem::path m_expectedLicenseFile;
+        /// Serialises checks & writes of m_expectedLicenseFile, eg a LicenseWatcher re-checking while an activation is writing the token
+        std::mutex m_licenseFileMutex;
         struct {
             std::atomic<bool> isLicenseActive{ false };
             std::atomic<bool> trial{ false };
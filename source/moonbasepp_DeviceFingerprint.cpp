@@ -21,6 +21,7 @@
 #endif
 #include <iostream>
 #include <cassert>
+#include <charconv>
 #include <optional>
 
 namespace moonbasepp {
@@ -195,29 +196,47 @@ namespace moonbasepp {
     static_assert(false); // TODO: SUPPORT OTHER OPERATING SYSTEMS
 #endif
     auto compareFingerprint(const DeviceFingerprint& cachedFingerprint, std::string base64ToCompare) -> bool {
-        try {
-            std::uint32_t decoded = std::stoi(base64_decode(base64ToCompare));
-            const std::uint8_t decodedCpuHash = (decoded >> 24) & 0xFF;
-            const std::uint8_t decodedVolumeHash = (decoded >> 16) & 0xFF;
-            const std::uint16_t decodedMacAddrHash = decoded & 0xFFFF;
-            // Say == if two of the 3 fields still match...
-            const auto numMatches = [&]() -> int {
-                int n{ 0 };
-                if (decodedCpuHash == cachedFingerprint.cpuHash) {
-                    ++n;
-                }
-                if (decodedVolumeHash == cachedFingerprint.volumeHash) {
-                    ++n;
-                }
-                if (decodedMacAddrHash == cachedFingerprint.macAddrHash) {
-                    ++n;
-                }
-                return n;
-            }();
-            return numMatches >= 2;
-        } catch (...) {
+        const auto decoded = fingerprintFromBase64(base64ToCompare);
+        if (!decoded) {
             assert(false);
             return false;
         }
+        // Say == if two of the 3 fields still match...
+        const auto numMatches = [&]() -> int {
+            int n{ 0 };
+            if (decoded->cpuHash == cachedFingerprint.cpuHash) {
+                ++n;
+            }
+            if (decoded->volumeHash == cachedFingerprint.volumeHash) {
+                ++n;
+            }
+            if (decoded->macAddrHash == cachedFingerprint.macAddrHash) {
+                ++n;
+            }
+            return n;
+        }();
+        return numMatches >= 2;
+    }
+
+    auto fingerprintFromBase64(const std::string& base64) -> std::optional<DeviceFingerprint> {
+        try {
+            // The whole string must be a uint32 - no sign, no trailing characters, and nothing that'd need truncating
+            const auto asString = base64_decode(base64);
+            std::uint32_t decoded{ 0 };
+            const auto [end, ec] = std::from_chars(asString.data(), asString.data() + asString.size(), decoded);
+            if (asString.empty() || ec != std::errc{} || end != asString.data() + asString.size()) {
+                return {};
+            }
+            return DeviceFingerprint{
+                .deviceName = {},
+                .cpuHash = static_cast<std::uint8_t>((decoded >> 24) & 0xFF),
+                .volumeHash = static_cast<std::uint8_t>((decoded >> 16) & 0xFF),
+                .macAddrHash = static_cast<std::uint16_t>(decoded & 0xFFFF),
+                .fingerprint = decoded,
+                .base64 = base64
+            };
+        } catch (...) {
+            return {};
+        }
     }
-} // namespace moonbasepp
\ No newline at end of file
+} // namespace moonbasepp
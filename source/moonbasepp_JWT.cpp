@@ -67,17 +67,83 @@ namespace moonbasepp::jwt {
         }
     }
 
-    auto verifySignature(const std::string& publicKey, const JWT& toVerify) -> bool {
+    /// JWS ES256 signatures are the raw r || s pair, whereas mbedtls expects an ASN.1 SEQUENCE { INTEGER r, INTEGER s }
+    static auto rawEcdsaSignatureToDer(std::string_view raw) -> std::string {
+        const auto encodeInteger = [](std::string_view bytes) -> std::string {
+            while (bytes.size() > 1 && bytes.front() == '\0') {
+                bytes.remove_prefix(1);
+            }
+            std::string res{ bytes };
+            if (static_cast<unsigned char>(res.front()) & 0x80) {
+                res.insert(res.begin(), '\0');
+            }
+            res.insert(res.begin(), static_cast<char>(res.size()));
+            res.insert(res.begin(), '\x02');
+            return res;
+        };
+        const auto half = raw.size() / 2;
+        const auto contents = encodeInteger(raw.substr(0, half)) + encodeInteger(raw.substr(half));
+        return std::string{ '\x30', static_cast<char>(contents.size()) } + contents;
+    }
+
+    struct PublicKey::Impl final {
+        Impl() {
+            mbedtls_pk_init(&ctx);
+        }
+
+        ~Impl() noexcept {
+            mbedtls_pk_free(&ctx);
+        }
+
         mbedtls_pk_context ctx;
-        scope_exit se{ [&ctx]() -> void { mbedtls_pk_free(&ctx); } };
-        mbedtls_pk_init(&ctx);
-        if (mbedtls_pk_parse_public_key(&ctx, reinterpret_cast<const unsigned char*>(publicKey.data()), publicKey.length() + 1) != 0) {
+    };
+
+    PublicKey::PublicKey() : m_impl(std::make_unique<Impl>()) {
+    }
+
+    PublicKey::PublicKey(PublicKey&& other) noexcept = default;
+    auto PublicKey::operator=(PublicKey&& other) noexcept -> PublicKey& = default;
+    PublicKey::~PublicKey() noexcept = default;
+
+    auto PublicKey::fromPem(const std::string& pem) -> std::optional<PublicKey> {
+        PublicKey res;
+        // mbedtls only recognises PEM input if the length includes the null terminator
+        if (mbedtls_pk_parse_public_key(&res.m_impl->ctx, reinterpret_cast<const unsigned char*>(pem.c_str()), pem.length() + 1) != 0) {
+            return {};
+        }
+        return res;
+    }
+
+    auto PublicKey::fromDer(std::span<const unsigned char> der) -> std::optional<PublicKey> {
+        PublicKey res;
+        if (mbedtls_pk_parse_public_key(&res.m_impl->ctx, der.data(), der.size()) != 0) {
+            return {};
+        }
+        return res;
+    }
+
+    auto verifySignature(PublicKey& publicKey, const JWT& toVerify) -> bool {
+        // The header is unauthenticated at this point, so don't assume anything about its shape
+        const auto& header = toVerify.header;
+        const auto isEcdsa = header.is_object() && header.contains("alg") && header.at("alg").is_string() && header.at("alg").get<std::string>() == "ES256";
+        if (isEcdsa && toVerify.signature.size() != 64) {
             return false;
         }
-        if (mbedtls_pk_verify(&ctx, mbedtls_md_type_t::MBEDTLS_MD_SHA256, toVerify.hash, sizeof(toVerify.hash), reinterpret_cast<const unsigned char*>(toVerify.signature.c_str()), toVerify.signature.length()) != 0) {
+        const auto signature = isEcdsa ? rawEcdsaSignatureToDer(toVerify.signature) : toVerify.signature;
+        if (mbedtls_pk_verify(&publicKey.m_impl->ctx, mbedtls_md_type_t::MBEDTLS_MD_SHA256, toVerify.hash, sizeof(toVerify.hash), reinterpret_cast<const unsigned char*>(signature.c_str()), signature.length()) != 0) {
             return false;
         }
         return true;
     }
 
+    auto verifySignature(const std::string& publicKey, const JWT& toVerify) -> bool {
+        auto key = PublicKey::fromPem(publicKey);
+        return key && verifySignature(*key, toVerify);
+    }
+
+    auto verifySignature(std::span<const unsigned char> publicKeyDer, const JWT& toVerify) -> bool {
+        auto key = PublicKey::fromDer(publicKeyDer);
+        return key && verifySignature(*key, toVerify);
+    }
+
 } // namespace moonbasepp::jwt
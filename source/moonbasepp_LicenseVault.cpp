@@ -0,0 +1,532 @@
+#include <moonbasepp/moonbasepp_LicenseVault.h>
+#include <moonbasepp/moonbasepp_JWT.h>
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <tuple>
+
+namespace moonbasepp {
+    static_assert(std::endian::native == std::endian::little, "The vault format is little-endian, and is read in place");
+
+    constexpr static std::array<char, 8> s_vaultMagic{ 'M', 'B', 'V', 'A', 'U', 'L', 'T', '\0' };
+    constexpr static std::uint32_t s_vaultVersion{ 1 };
+
+    /// Everything is stored in place, so these layouts are the file format - bump s_vaultVersion if they change
+    struct VaultHeader final {
+        std::array<char, 8> magic;
+        std::uint32_t version;
+        std::uint32_t entryCount;
+        std::uint64_t indexOffset;
+        std::uint64_t dataOffset;
+        std::uint64_t fileSize;
+        std::uint64_t reserved;
+    };
+    static_assert(sizeof(VaultHeader) == 48);
+
+    struct VaultIndexEntry final {
+        /// The product id, immediately followed by the device signature
+        std::uint64_t keyOffset;
+        std::uint32_t productIdLength;
+        std::uint32_t deviceSignatureLength;
+        std::uint64_t tokenOffset;
+        std::uint32_t tokenLength;
+        std::uint8_t trial;
+        std::uint8_t offline;
+        std::uint16_t reserved;
+        std::int64_t expiresAt;
+        std::int64_t validatedAt;
+    };
+    static_assert(sizeof(VaultIndexEntry) == 48);
+
+    /// A read-only view of a vault file, unmapped on destruction
+    struct LicenseVault::Mapping final {
+        Mapping() = default;
+        Mapping(const Mapping&) = delete;
+        ~Mapping() noexcept {
+            if (!data) {
+                return;
+            }
+#if defined(_WIN32)
+            UnmapViewOfFile(data);
+#else
+            munmap(const_cast<char*>(data), size);
+#endif
+        }
+
+        template <typename T>
+        [[nodiscard]] auto read(std::uint64_t offset) const -> T {
+            T res;
+            std::memcpy(&res, data + offset, sizeof(T));
+            return res;
+        }
+
+        const char* data{ nullptr };
+        std::size_t size{ 0 };
+        VaultHeader header{};
+    };
+
+    /// An owned copy of an entry, for building a new vault
+    struct LicenseVault::Record final {
+        std::string productId;
+        std::string deviceSignature;
+        std::string token;
+        bool trial;
+        bool offline;
+        std::int64_t expiresAt;
+        std::int64_t validatedAt;
+    };
+
+    /// An exclusive lock on a file alongside the vault, serialising read-modify-write cycles across processes. Released on destruction
+    class VaultWriteLock final {
+    public:
+        explicit VaultWriteLock(const std::filesystem::path& lockFile) {
+#if defined(_WIN32)
+            m_file = CreateFileW(lockFile.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (m_file == INVALID_HANDLE_VALUE) {
+                return;
+            }
+            OVERLAPPED overlapped{};
+            m_isLocked = LockFileEx(m_file, LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD, MAXDWORD, &overlapped) != 0;
+#else
+            m_fd = open(lockFile.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+            if (m_fd < 0) {
+                return;
+            }
+            auto res{ 0 };
+            while ((res = flock(m_fd, LOCK_EX)) != 0 && errno == EINTR) {
+            }
+            m_isLocked = res == 0;
+#endif
+        }
+
+        VaultWriteLock(const VaultWriteLock&) = delete;
+
+        ~VaultWriteLock() noexcept {
+#if defined(_WIN32)
+            if (m_file == INVALID_HANDLE_VALUE) {
+                return;
+            }
+            if (m_isLocked) {
+                OVERLAPPED overlapped{};
+                UnlockFileEx(m_file, 0, MAXDWORD, MAXDWORD, &overlapped);
+            }
+            CloseHandle(m_file);
+#else
+            if (m_fd >= 0) {
+                close(m_fd); // releases the flock
+            }
+#endif
+        }
+
+        [[nodiscard]] auto isLocked() const -> bool {
+            return m_isLocked;
+        }
+
+    private:
+#if defined(_WIN32)
+        HANDLE m_file{ INVALID_HANDLE_VALUE };
+#else
+        int m_fd{ -1 };
+#endif
+        bool m_isLocked{ false };
+    };
+
+    auto LicenseVault::mapFile(const std::filesystem::path& path) -> std::unique_ptr<Mapping> {
+        auto res = std::make_unique<Mapping>();
+#if defined(_WIN32)
+        // FILE_SHARE_DELETE so writers can still rename a new vault over this one while it's mapped
+        const auto file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return nullptr;
+        }
+        LARGE_INTEGER fileSize{};
+        if (!GetFileSizeEx(file, &fileSize) || static_cast<std::uint64_t>(fileSize.QuadPart) < sizeof(VaultHeader)) {
+            CloseHandle(file);
+            return nullptr;
+        }
+        const auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (!mapping) {
+            return nullptr;
+        }
+        auto* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping); // the view keeps the mapping alive
+        if (!view) {
+            return nullptr;
+        }
+        res->data = static_cast<const char*>(view);
+        res->size = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+        const auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return nullptr;
+        }
+        struct stat info{};
+        if (fstat(fd, &info) != 0 || static_cast<std::uint64_t>(info.st_size) < sizeof(VaultHeader)) {
+            close(fd);
+            return nullptr;
+        }
+        auto* view = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        close(fd); // the mapping keeps the file alive
+        if (view == MAP_FAILED) {
+            return nullptr;
+        }
+        res->data = static_cast<const char*>(view);
+        res->size = static_cast<std::size_t>(info.st_size);
+#endif
+        res->header = res->read<VaultHeader>(0);
+        const auto& header = res->header;
+        const auto isValid = header.magic == s_vaultMagic &&
+                             header.version == s_vaultVersion &&
+                             header.fileSize == res->size &&
+                             header.indexOffset == sizeof(VaultHeader) &&
+                             header.dataOffset == header.indexOffset + static_cast<std::uint64_t>(header.entryCount) * sizeof(VaultIndexEntry) &&
+                             header.dataOffset <= res->size;
+        if (!isValid) {
+            return nullptr;
+        }
+        return res;
+    }
+
+    /// Bounds checked on every access, so a corrupt vault reads as missing entries rather than out of bounds
+    auto LicenseVault::readEntry(const Mapping& mapping, std::uint32_t index) -> std::optional<Entry> {
+        const auto entry = mapping.read<VaultIndexEntry>(mapping.header.indexOffset + static_cast<std::uint64_t>(index) * sizeof(VaultIndexEntry));
+        const auto isInData = [&mapping](std::uint64_t offset, std::uint64_t length) -> bool {
+            return offset >= mapping.header.dataOffset && offset <= mapping.size && length <= mapping.size - offset;
+        };
+        const auto keyLength = static_cast<std::uint64_t>(entry.productIdLength) + entry.deviceSignatureLength;
+        if (!isInData(entry.keyOffset, keyLength) || !isInData(entry.tokenOffset, entry.tokenLength)) {
+            return {};
+        }
+        return Entry{
+            .productId = { mapping.data + entry.keyOffset, entry.productIdLength },
+            .deviceSignature = { mapping.data + entry.keyOffset + entry.productIdLength, entry.deviceSignatureLength },
+            .token = { mapping.data + entry.tokenOffset, entry.tokenLength },
+            .trial = entry.trial != 0,
+            .offline = entry.offline != 0,
+            .expiresAt = entry.expiresAt,
+            .validatedAt = entry.validatedAt,
+            .storage = {}
+        };
+    }
+
+    auto LicenseVault::readRecords(const Mapping* mapping) -> std::optional<std::vector<Record>> {
+        std::vector<Record> res;
+        if (!mapping) {
+            return res;
+        }
+        res.reserve(mapping->header.entryCount);
+        for (std::uint32_t i = 0; i < mapping->header.entryCount; ++i) {
+            const auto entry = readEntry(*mapping, i);
+            if (!entry) { // corrupt - rewriting the vault without this entry would silently drop it
+                return {};
+            }
+            res.push_back({ .productId = std::string{ entry->productId },
+                            .deviceSignature = std::string{ entry->deviceSignature },
+                            .token = std::string{ entry->token },
+                            .trial = entry->trial,
+                            .offline = entry->offline,
+                            .expiresAt = entry->expiresAt,
+                            .validatedAt = entry->validatedAt });
+        }
+        return res;
+    }
+
+    auto LicenseVault::readLatestRecords() const -> std::optional<std::vector<Record>> {
+        // Start from what's on disk rather than our mapping, so we don't drop another process' writes
+        const auto latest = mapFile(m_vaultFile);
+        if (!latest) {
+            // Only a missing vault means "no records" - rewriting an unreadable one (or one we can't stat) would wipe it
+            std::error_code ec;
+            if (std::filesystem::exists(m_vaultFile, ec) || ec) {
+                return {};
+            }
+        }
+        return readRecords(latest.get());
+    }
+
+    LicenseVault::LicenseVault(std::filesystem::path vaultFile) : m_vaultFile(std::move(vaultFile)) {
+        m_mapping = mapFile(m_vaultFile);
+    }
+
+    LicenseVault::~LicenseVault() noexcept = default;
+
+    auto LicenseVault::getLockFile() const -> std::filesystem::path {
+        auto lockFile = m_vaultFile;
+        lockFile += ".lock";
+        return lockFile;
+    }
+
+    auto LicenseVault::getMapping() const -> std::shared_ptr<const Mapping> {
+        std::scoped_lock sl{ m_mappingMutex };
+        return m_mapping;
+    }
+
+    auto LicenseVault::reload() -> bool {
+        std::shared_ptr<const Mapping> mapping = mapFile(m_vaultFile);
+        std::error_code ec;
+        if (!mapping && (std::filesystem::exists(m_vaultFile, ec) || ec)) {
+            return false;
+        }
+        std::scoped_lock sl{ m_mappingMutex };
+        m_mapping = std::move(mapping);
+        return true;
+    }
+
+    auto LicenseVault::find(std::string_view productId, std::string_view deviceSignature) const -> std::optional<Entry> {
+        auto mapping = getMapping();
+        if (!mapping) {
+            return {};
+        }
+        const auto key = std::tie(productId, deviceSignature);
+        std::uint32_t low{ 0 }, high{ mapping->header.entryCount };
+        while (low < high) {
+            const auto mid = low + (high - low) / 2;
+            auto entry = readEntry(*mapping, mid);
+            if (!entry) {
+                return {};
+            }
+            const auto entryKey = std::tie(entry->productId, entry->deviceSignature);
+            if (entryKey < key) {
+                low = mid + 1;
+            } else if (key < entryKey) {
+                high = mid;
+            } else {
+                entry->storage = std::move(mapping);
+                return entry;
+            }
+        }
+        return {};
+    }
+
+    auto LicenseVault::size() const -> std::size_t {
+        const auto mapping = getMapping();
+        return mapping ? mapping->header.entryCount : 0;
+    }
+
+    auto LicenseVault::store(std::string_view token, jwt::PublicKey& publicKey) -> bool {
+        const auto jwt_opt = jwt::decode(token);
+        if (!jwt_opt || !jwt::verifySignature(publicKey, *jwt_opt)) {
+            return false;
+        }
+        Record record;
+        try {
+            const auto& body = jwt_opt->body;
+            record = {
+                .productId = body.at("p:id").get<std::string>(),
+                .deviceSignature = body.at("sig").get<std::string>(),
+                .token = std::string{ token },
+                .trial = body.value("trial", false),
+                .offline = body.value("method", "") == "Offline",
+                .expiresAt = body.value<std::int64_t>("exp", 0),
+                .validatedAt = body.value<std::int64_t>("validated", 0)
+            };
+        } catch (...) {
+            return false;
+        }
+        try {
+            if (m_vaultFile.has_parent_path()) {
+                std::filesystem::create_directories(m_vaultFile.parent_path());
+            }
+        } catch (...) {
+            return false;
+        }
+        std::scoped_lock sl{ m_writeMutex };
+        // Held until the new vault has been swapped in, so no other writer (in any process) can slip a write in between our read and ours
+        const VaultWriteLock writeLock{ getLockFile() };
+        if (!writeLock.isLocked()) {
+            return false;
+        }
+        auto latest = readLatestRecords();
+        if (!latest) {
+            return false;
+        }
+        auto& records = *latest;
+        const auto existing = std::find_if(records.begin(), records.end(), [&record](const Record& r) -> bool {
+            return r.productId == record.productId && r.deviceSignature == record.deviceSignature;
+        });
+        if (existing != records.end()) {
+            *existing = std::move(record);
+        } else {
+            records.emplace_back(std::move(record));
+        }
+        return write(records);
+    }
+
+    auto LicenseVault::remove(std::string_view productId, std::string_view deviceSignature) -> bool {
+        std::scoped_lock sl{ m_writeMutex };
+        const VaultWriteLock writeLock{ getLockFile() };
+        if (!writeLock.isLocked()) {
+            return false;
+        }
+        auto latest = readLatestRecords();
+        if (!latest) {
+            return false;
+        }
+        auto& records = *latest;
+        const auto removed = std::erase_if(records, [&](const Record& r) -> bool {
+            return r.productId == productId && r.deviceSignature == deviceSignature;
+        });
+        if (removed == 0) {
+            return false;
+        }
+        return write(records);
+    }
+
+    /**
+     * Writes contents to tempFile, flushes it to disk, then swaps it in as target - so a crash leaves either the old or the new
+     * vault, never a truncated one. tempFile is removed on failure.
+     */
+    static auto replaceFile(const std::filesystem::path& target, const std::filesystem::path& tempFile, std::string_view contents) -> bool {
+#if defined(_WIN32)
+        // DELETE access, so the handle can be used to rename the file below
+        const auto file = CreateFileW(tempFile.c_str(), GENERIC_WRITE | DELETE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        auto isWritten{ true };
+        for (std::size_t offset = 0; isWritten && offset < contents.size();) {
+            const auto toWrite = static_cast<DWORD>(std::min<std::size_t>(contents.size() - offset, 1u << 30));
+            DWORD written{ 0 };
+            isWritten = WriteFile(file, contents.data() + offset, toWrite, &written, nullptr) && written > 0;
+            offset += written;
+        }
+        isWritten = isWritten && FlushFileBuffers(file);
+        auto isReplaced{ false };
+#if defined(FILE_RENAME_FLAG_POSIX_SEMANTICS)
+        if (isWritten) {
+            // A plain MoveFileEx fails while any process has the old vault mapped - POSIX semantics unlink it from the directory
+            // immediately instead, leaving existing mappings (which were opened with FILE_SHARE_DELETE) intact
+            std::error_code ec;
+            const auto absoluteTarget = std::filesystem::absolute(target, ec);
+            const auto targetName = (ec ? target : absoluteTarget).wstring();
+            const auto infoSize = sizeof(FILE_RENAME_INFO) + targetName.size() * sizeof(wchar_t);
+            std::vector<std::byte> infoBuffer(infoSize);
+            auto* info = reinterpret_cast<FILE_RENAME_INFO*>(infoBuffer.data());
+            info->Flags = FILE_RENAME_FLAG_POSIX_SEMANTICS | FILE_RENAME_FLAG_REPLACE_IF_EXISTS;
+            info->RootDirectory = nullptr;
+            info->FileNameLength = static_cast<DWORD>(targetName.size() * sizeof(wchar_t));
+            std::memcpy(info->FileName, targetName.c_str(), targetName.size() * sizeof(wchar_t));
+            isReplaced = SetFileInformationByHandle(file, FileRenameInfoEx, info, static_cast<DWORD>(infoSize)) != 0;
+        }
+#endif
+        CloseHandle(file);
+        if (isWritten && !isReplaced) {
+            // Pre Windows 10 1607, or a file system without POSIX rename support - only succeeds if nothing has the vault mapped
+            isReplaced = MoveFileExW(tempFile.c_str(), target.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+        }
+        if (!isReplaced) {
+            DeleteFileW(tempFile.c_str());
+        }
+        return isReplaced;
+#else
+        const auto fd = open(tempFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            return false;
+        }
+        auto isWritten{ true };
+        for (std::size_t offset = 0; isWritten && offset < contents.size();) {
+            const auto written = ::write(fd, contents.data() + offset, contents.size() - offset);
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            isWritten = written > 0;
+            offset += isWritten ? static_cast<std::size_t>(written) : 0;
+        }
+        // Without the fsync, a crash shortly after the rename can leave the new name pointing at an empty or partial file
+        isWritten = isWritten && fsync(fd) == 0;
+        isWritten = close(fd) == 0 && isWritten;
+        if (!isWritten || ::rename(tempFile.c_str(), target.c_str()) != 0) {
+            unlink(tempFile.c_str());
+            return false;
+        }
+        // Persist the rename itself - best effort, as not every file system supports syncing a directory
+        const auto directory = target.has_parent_path() ? target.parent_path() : std::filesystem::path{ "." };
+        if (const auto directoryFd = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC); directoryFd >= 0) {
+            fsync(directoryFd);
+            close(directoryFd);
+        }
+        return true;
+#endif
+    }
+
+    auto LicenseVault::write(const std::vector<Record>& records) -> bool {
+        std::vector<const Record*> sorted;
+        sorted.reserve(records.size());
+        for (const auto& record : records) {
+            sorted.push_back(&record);
+        }
+        std::sort(sorted.begin(), sorted.end(), [](const Record* a, const Record* b) -> bool {
+            return std::tie(a->productId, a->deviceSignature) < std::tie(b->productId, b->deviceSignature);
+        });
+
+        VaultHeader header{
+            .magic = s_vaultMagic,
+            .version = s_vaultVersion,
+            .entryCount = static_cast<std::uint32_t>(sorted.size()),
+            .indexOffset = sizeof(VaultHeader),
+            .dataOffset = sizeof(VaultHeader) + sorted.size() * sizeof(VaultIndexEntry),
+            .fileSize = 0,
+            .reserved = 0
+        };
+        std::vector<VaultIndexEntry> index;
+        index.reserve(sorted.size());
+        std::string data;
+        for (const auto* record : sorted) {
+            const auto keyOffset = header.dataOffset + data.size();
+            data += record->productId;
+            data += record->deviceSignature;
+            const auto tokenOffset = header.dataOffset + data.size();
+            data += record->token;
+            index.push_back({ .keyOffset = keyOffset,
+                              .productIdLength = static_cast<std::uint32_t>(record->productId.size()),
+                              .deviceSignatureLength = static_cast<std::uint32_t>(record->deviceSignature.size()),
+                              .tokenOffset = tokenOffset,
+                              .tokenLength = static_cast<std::uint32_t>(record->token.size()),
+                              .trial = static_cast<std::uint8_t>(record->trial),
+                              .offline = static_cast<std::uint8_t>(record->offline),
+                              .reserved = 0,
+                              .expiresAt = record->expiresAt,
+                              .validatedAt = record->validatedAt });
+        }
+        header.fileSize = header.dataOffset + data.size();
+        std::string contents;
+        contents.reserve(header.fileSize);
+        contents.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        contents.append(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(VaultIndexEntry));
+        contents += data;
+
+        // Unique per process & write, so concurrent writers never share a temp file
+        static std::atomic<std::uint32_t> s_writeCount{ 0 };
+#if defined(_WIN32)
+        const auto processId = static_cast<std::uint64_t>(GetCurrentProcessId());
+#else
+        const auto processId = static_cast<std::uint64_t>(getpid());
+#endif
+        auto tempFile = m_vaultFile;
+        tempFile += "." + std::to_string(processId) + "." + std::to_string(s_writeCount++) + ".tmp";
+        if (!replaceFile(m_vaultFile, tempFile, contents)) {
+            return false;
+        }
+        std::shared_ptr<const Mapping> mapping = mapFile(m_vaultFile);
+        std::scoped_lock sl{ m_mappingMutex };
+        m_mapping = std::move(mapping);
+        return true;
+    }
+
+} // namespace moonbasepp
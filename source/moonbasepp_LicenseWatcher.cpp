@@ -0,0 +1,461 @@
+#include <moonbasepp/moonbasepp_LicenseWatcher.h>
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#elif __APPLE__
+#include <sys/event.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#elif defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+#include <cstdint>
+#include <fstream>
+
+namespace moonbasepp {
+
+    LicenseWatcher::LicenseWatcher(Licensing& licensing, std::chrono::milliseconds debounceTime, std::chrono::milliseconds pollInterval) : m_licensing(licensing),
+                                                                                                                                          m_debounceTime(debounceTime),
+                                                                                                                                          m_pollInterval(pollInterval) {
+        m_lastSeenToken = readLicenseFile();
+        m_lastSeenState = getLicenseFileState();
+#if defined(__linux__)
+        m_wakeFd = eventfd(0, EFD_CLOEXEC);
+#elif __APPLE__
+        m_wakeFd = kqueue();
+        if (m_wakeFd != -1) {
+            struct kevent wake{};
+            EV_SET(&wake, 0, EVFILT_USER, EV_ADD | EV_CLEAR, 0, 0, nullptr);
+            if (kevent(m_wakeFd, &wake, 1, nullptr, 0, nullptr) != 0) {
+                close(m_wakeFd);
+                m_wakeFd = -1;
+            }
+        }
+#elif defined(_WIN32)
+        m_wakeEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+#endif
+        m_thread = std::thread{ [this]() -> void { run(); } };
+    }
+
+    LicenseWatcher::~LicenseWatcher() noexcept {
+        {
+            std::scoped_lock sl{ m_stopMutex };
+            m_stop.store(true);
+        }
+        m_stopCv.notify_all();
+#if defined(__linux__)
+        if (m_wakeFd != -1) {
+            const std::uint64_t value{ 1 };
+            [[maybe_unused]] const auto written = write(m_wakeFd, &value, sizeof(value));
+        }
+#elif __APPLE__
+        if (m_wakeFd != -1) {
+            struct kevent wake{};
+            EV_SET(&wake, 0, EVFILT_USER, 0, NOTE_TRIGGER, 0, nullptr);
+            kevent(m_wakeFd, &wake, 1, nullptr, 0, nullptr);
+        }
+#elif defined(_WIN32)
+        if (m_wakeEvent) {
+            SetEvent(m_wakeEvent);
+        }
+#endif
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+#if defined(_WIN32)
+        if (m_wakeEvent) {
+            CloseHandle(m_wakeEvent);
+        }
+#else
+        if (m_wakeFd != -1) {
+            close(m_wakeFd);
+        }
+#endif
+    }
+
+    auto LicenseWatcher::subscribe(Listener listener) -> int {
+        std::scoped_lock sl{ m_listenerMutex };
+        const auto id = m_nextListenerId++;
+        m_listeners.emplace(id, std::move(listener));
+        return id;
+    }
+
+    auto LicenseWatcher::unsubscribe(int id) -> void {
+        std::scoped_lock sl{ m_listenerMutex };
+        m_listeners.erase(id);
+    }
+
+    auto LicenseWatcher::readLicenseFile() const -> std::string {
+        std::ifstream inStream{ m_licensing.getLicenseFile(), std::ios::in };
+        if (!inStream) {
+            return {};
+        }
+        return { std::istreambuf_iterator<char>(inStream), std::istreambuf_iterator<char>() };
+    }
+
+    auto LicenseWatcher::getLicenseFileState() const -> FileState {
+        const auto& licenseFile = m_licensing.getLicenseFile();
+        std::error_code ec;
+        if (!std::filesystem::exists(licenseFile, ec)) {
+            return {};
+        }
+        FileState state{ .exists = true };
+        state.size = std::filesystem::file_size(licenseFile, ec);
+        if (ec) {
+            state.size = 0;
+        }
+        state.lastWriteTime = std::filesystem::last_write_time(licenseFile, ec);
+        return state;
+    }
+
+    auto LicenseWatcher::waitFor(std::chrono::milliseconds duration) -> bool {
+        std::unique_lock lock{ m_stopMutex };
+        return !m_stopCv.wait_for(lock, duration, [this]() -> bool { return m_stop.load(); });
+    }
+
+    auto LicenseWatcher::onLicenseFileChanged() -> void {
+        try {
+            auto token = readLicenseFile();
+            if (token == m_lastSeenToken) { // touched, or rewritten with the same contents - nothing to do
+                return;
+            }
+            m_lastSeenToken = std::move(token);
+            [[maybe_unused]] const auto isActive = m_licensing.checkForExisting();
+        } catch (...) { // eg a token missing a claim - nothing to publish, and the watcher thread must survive it
+            return;
+        }
+        const auto status = m_licensing.getLicenseStatus();
+        std::scoped_lock sl{ m_listenerMutex };
+        for (const auto& [id, listener] : m_listeners) {
+            try {
+                listener(status);
+            } catch (...) { // a throwing listener shouldn't stop the others (or the watcher) from running
+                continue;
+            }
+        }
+    }
+
+    auto LicenseWatcher::runPolling() -> void {
+        while (waitFor(m_pollInterval)) {
+            // Only stat while idle - the file is just read once its size or modification time has changed, and then settled
+            auto current = getLicenseFileState();
+            if (current == m_lastSeenState) {
+                continue;
+            }
+            // Still being written? Wait until two consecutive stats agree
+            auto isStable{ false };
+            while (!isStable && waitFor(m_debounceTime)) {
+                const auto next = getLicenseFileState();
+                isStable = next == current;
+                current = next;
+            }
+            if (isStable) {
+                m_lastSeenState = current;
+                onLicenseFileChanged();
+            }
+        }
+    }
+
+#if defined(__linux__)
+    auto LicenseWatcher::run() -> void {
+        const auto inotifyFd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+        if (inotifyFd < 0 || m_wakeFd < 0) {
+            if (inotifyFd >= 0) {
+                close(inotifyFd);
+            }
+            runPolling();
+            return;
+        }
+        const auto licenseFile = m_licensing.getLicenseFile();
+        const auto watchedFileName = licenseFile.filename().string();
+        // Watch the directory rather than the file, so we still see the file being created, replaced via rename, or deleted
+        constexpr auto mask = IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF;
+        const auto watchedDirectory = licenseFile.parent_path();
+        auto watchFd = inotify_add_watch(inotifyFd, watchedDirectory.c_str(), mask);
+        if (watchFd < 0) {
+            close(inotifyFd);
+            runPolling();
+            return;
+        }
+        pollfd fds[2]{
+            { .fd = inotifyFd, .events = POLLIN, .revents = 0 },
+            { .fd = m_wakeFd, .events = POLLIN, .revents = 0 }
+        };
+        alignas(inotify_event) char buffer[4096];
+        auto isChangePending{ false };
+        while (!m_stop.load()) {
+            // Block indefinitely while idle - only time out while waiting for a pending change to settle
+            const auto timeout = isChangePending ? static_cast<int>(m_debounceTime.count()) : -1;
+            const auto res = poll(fds, 2, timeout);
+            if (res < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            if (fds[1].revents & POLLIN) {
+                break;
+            }
+            if (res == 0) {
+                isChangePending = false;
+                onLicenseFileChanged();
+                continue;
+            }
+            auto isWatchLost{ false };
+            ssize_t bytesRead;
+            while ((bytesRead = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+                for (auto* ptr = buffer; ptr < buffer + bytesRead;) {
+                    const auto* event = reinterpret_cast<const inotify_event*>(ptr);
+                    ptr += sizeof(inotify_event) + event->len;
+                    if (event->mask & IN_Q_OVERFLOW) { // events were dropped, so we can't tell whether the file was among them
+                        isChangePending = true;
+                        continue;
+                    }
+                    if (event->wd != watchFd) { // left over from a watch we've already replaced
+                        continue;
+                    }
+                    if (event->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF)) {
+                        // The directory was deleted, moved or unmounted - a moved directory keeps its watch, so drop it explicitly
+                        isWatchLost = true;
+                        continue;
+                    }
+                    if (event->len > 0 && watchedFileName == event->name) {
+                        isChangePending = true;
+                    }
+                }
+            }
+            if (!isWatchLost) {
+                continue;
+            }
+            inotify_rm_watch(inotifyFd, watchFd);
+            // The license file has gone along with its directory - report that straight away, rather than once the directory comes back
+            isChangePending = false;
+            onLicenseFileChanged();
+            while ((watchFd = inotify_add_watch(inotifyFd, watchedDirectory.c_str(), mask)) < 0 && waitFor(m_pollInterval)) {
+            }
+            if (watchFd < 0) { // stopped while waiting
+                break;
+            }
+            // Anything could have been written while we weren't watching
+            isChangePending = true;
+        }
+        close(inotifyFd);
+    }
+#elif __APPLE__
+    auto LicenseWatcher::run() -> void {
+        if (m_wakeFd < 0) {
+            runPolling();
+            return;
+        }
+        const auto kq = m_wakeFd;
+        const auto licenseFile = m_licensing.getLicenseFile();
+        const auto watchedDirectory = licenseFile.parent_path();
+        const auto addWatch = [kq](int fd, unsigned int flags) -> bool {
+            struct kevent change{};
+            EV_SET(&change, fd, EVFILT_VNODE, EV_ADD | EV_CLEAR, flags, 0, nullptr);
+            return kevent(kq, &change, 1, nullptr, 0, nullptr) == 0;
+        };
+        // A directory's vnode only reports entries being added, removed or renamed - in place writes to the license file only show up
+        // on the file's own vnode, so watch both. Closing a descriptor removes its watch
+        int directoryFd{ -1 };
+        int fileFd{ -1 };
+        const auto closeWatches = [&]() -> void {
+            for (auto* fd : { &fileFd, &directoryFd }) {
+                if (*fd != -1) {
+                    close(*fd);
+                    *fd = -1;
+                }
+            }
+        };
+        // (Re)opens the file's watch, which needs redoing whenever the file is created or replaced - false if the directory is missing
+        const auto updateWatches = [&]() -> bool {
+            if (directoryFd == -1) {
+                directoryFd = open(watchedDirectory.c_str(), O_EVTONLY | O_CLOEXEC);
+                if (directoryFd == -1 || !addWatch(directoryFd, NOTE_WRITE | NOTE_DELETE | NOTE_RENAME | NOTE_REVOKE)) {
+                    closeWatches();
+                    return false;
+                }
+            }
+            if (fileFd != -1) {
+                close(fileFd);
+            }
+            fileFd = open(licenseFile.c_str(), O_EVTONLY | O_CLOEXEC);
+            if (fileFd != -1 && !addWatch(fileFd, NOTE_WRITE | NOTE_EXTEND | NOTE_ATTRIB | NOTE_DELETE | NOTE_RENAME | NOTE_REVOKE)) {
+                close(fileFd);
+                fileFd = -1;
+            }
+            return true;
+        };
+        if (!updateWatches()) {
+            runPolling();
+            return;
+        }
+        struct kevent events[8];
+        auto isChangePending{ false };
+        while (!m_stop.load()) {
+            // Block indefinitely while idle - only time out while waiting for a pending change to settle
+            const auto debounceNs = std::chrono::duration_cast<std::chrono::nanoseconds>(m_debounceTime).count();
+            const timespec debounce{ .tv_sec = static_cast<time_t>(debounceNs / 1'000'000'000), .tv_nsec = static_cast<long>(debounceNs % 1'000'000'000) };
+            const auto res = kevent(kq, nullptr, 0, events, 8, isChangePending ? &debounce : nullptr);
+            if (res < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            if (res == 0) {
+                isChangePending = false;
+                onLicenseFileChanged();
+                continue;
+            }
+            auto isStopping{ false };
+            auto isWatchLost{ false };
+            for (auto i = 0; i < res; ++i) {
+                const auto& event = events[i];
+                if (event.filter == EVFILT_USER) {
+                    isStopping = true;
+                    break;
+                }
+                if (static_cast<int>(event.ident) == directoryFd && (event.fflags & (NOTE_DELETE | NOTE_RENAME | NOTE_REVOKE))) {
+                    isWatchLost = true;
+                }
+                isChangePending = true;
+            }
+            if (isStopping) {
+                break;
+            }
+            if (!isWatchLost) {
+                updateWatches();
+                continue;
+            }
+            closeWatches();
+            // The license file has gone along with its directory - report that straight away, rather than once the directory comes back
+            isChangePending = false;
+            onLicenseFileChanged();
+            auto isWatching{ false };
+            while (!(isWatching = updateWatches()) && waitFor(m_pollInterval)) {
+            }
+            if (!isWatching) { // stopped while waiting
+                break;
+            }
+            // Anything could have been written while we weren't watching
+            isChangePending = true;
+        }
+        closeWatches();
+    }
+#elif defined(_WIN32)
+    auto LicenseWatcher::run() -> void {
+        if (!m_wakeEvent) {
+            runPolling();
+            return;
+        }
+        const auto licenseFile = m_licensing.getLicenseFile();
+        const auto watchedFileName = licenseFile.filename().wstring();
+        const auto watchedDirectory = licenseFile.parent_path();
+        const auto openDirectory = [&watchedDirectory]() -> HANDLE {
+            // FILE_SHARE_DELETE, so watching doesn't stop the directory being deleted or renamed
+            return CreateFileW(watchedDirectory.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                               OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+        };
+        auto directory = openDirectory();
+        const auto readEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        if (directory == INVALID_HANDLE_VALUE || !readEvent) {
+            if (directory != INVALID_HANDLE_VALUE) {
+                CloseHandle(directory);
+            }
+            if (readEvent) {
+                CloseHandle(readEvent);
+            }
+            runPolling();
+            return;
+        }
+        constexpr DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE;
+        alignas(FILE_NOTIFY_INFORMATION) char buffer[16 * 1024];
+        OVERLAPPED overlapped{};
+        overlapped.hEvent = readEvent;
+        auto isReadPending{ false };
+        const auto cancelRead = [&]() -> void {
+            if (!isReadPending) {
+                return;
+            }
+            CancelIoEx(directory, &overlapped);
+            DWORD bytes{ 0 };
+            GetOverlappedResult(directory, &overlapped, &bytes, TRUE); // the buffer must outlive the read
+            isReadPending = false;
+        };
+        const HANDLE handles[2]{ readEvent, m_wakeEvent };
+        auto isChangePending{ false };
+        while (!m_stop.load()) {
+            auto isWatchLost{ false };
+            if (!isReadPending) {
+                ResetEvent(readEvent);
+                isReadPending = ReadDirectoryChangesW(directory, buffer, sizeof(buffer), FALSE, filter, nullptr, &overlapped, nullptr) != 0;
+                isWatchLost = !isReadPending;
+            }
+            if (!isWatchLost) {
+                // Block indefinitely while idle - only time out while waiting for a pending change to settle
+                const auto timeout = isChangePending ? static_cast<DWORD>(m_debounceTime.count()) : INFINITE;
+                const auto res = WaitForMultipleObjects(2, handles, FALSE, timeout);
+                if (res == WAIT_TIMEOUT) {
+                    isChangePending = false;
+                    onLicenseFileChanged();
+                    continue;
+                }
+                if (res != WAIT_OBJECT_0) { // woken for shutdown, or the wait itself failed
+                    break;
+                }
+                isReadPending = false;
+                DWORD bytesRead{ 0 };
+                if (!GetOverlappedResult(directory, &overlapped, &bytesRead, FALSE)) {
+                    // ERROR_NOTIFY_ENUM_DIR means events were dropped - anything else, and the directory has most likely gone
+                    isWatchLost = GetLastError() != ERROR_NOTIFY_ENUM_DIR;
+                    isChangePending = true;
+                } else if (bytesRead == 0) { // the buffer overflowed, so we can't tell whether the file was among the changes
+                    isChangePending = true;
+                }
+                for (DWORD offset = 0; bytesRead > 0 && !isWatchLost;) {
+                    const auto* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(buffer + offset);
+                    const auto nameLength = static_cast<int>(info->FileNameLength / sizeof(WCHAR));
+                    if (CompareStringOrdinal(info->FileName, nameLength, watchedFileName.c_str(), static_cast<int>(watchedFileName.size()), TRUE) == CSTR_EQUAL) {
+                        isChangePending = true;
+                    }
+                    if (info->NextEntryOffset == 0) {
+                        break;
+                    }
+                    offset += info->NextEntryOffset;
+                }
+            }
+            if (!isWatchLost) {
+                continue;
+            }
+            cancelRead();
+            CloseHandle(directory);
+            // The license file has most likely gone along with its directory - report that straight away
+            isChangePending = false;
+            onLicenseFileChanged();
+            while ((directory = openDirectory()) == INVALID_HANDLE_VALUE && waitFor(m_pollInterval)) {
+            }
+            if (directory == INVALID_HANDLE_VALUE) { // stopped while waiting
+                break;
+            }
+            // Anything could have been written while we weren't watching
+            isChangePending = true;
+        }
+        if (directory != INVALID_HANDLE_VALUE) {
+            cancelRead();
+            CloseHandle(directory);
+        }
+        CloseHandle(readEvent);
+    }
+#else
+    auto LicenseWatcher::run() -> void {
+        runPolling();
+    }
+#endif
+
+} // namespace moonbasepp
@@ -39,10 +39,9 @@ namespace moonbasepp {
         return resp;
     }
 
-    static auto getTrialDaysRemaining(int trialExpiration) -> int {
-        const auto now = std::chrono::system_clock::now();
+    static auto getTrialDaysRemaining(int trialExpiration, std::chrono::system_clock::time_point now) -> int {
         const auto expTimePoint = std::chrono::system_clock::from_time_t(trialExpiration);
-        const auto deltaDays = std::chrono::duration_cast<std::chrono::days>(now - expTimePoint);
+        const auto deltaDays = std::chrono::duration_cast<std::chrono::days>(expTimePoint - now);
         return deltaDays.count();
     }
 
@@ -97,7 +96,8 @@ namespace moonbasepp {
         if (!jwt_opt) {
             return false;
         }
-        if (!jwt::verifySignature(m_context.publicKey.data(), *jwt_opt)) {
+        const auto isSignatureValid = m_context.publicKeyDer.empty() ? jwt::verifySignature(std::string{ m_context.publicKey }, *jwt_opt) : jwt::verifySignature(m_context.publicKeyDer, *jwt_opt);
+        if (!isSignatureValid) {
             return false;
         }
         auto& asJson = jwt_opt->body;
@@ -119,7 +119,7 @@ namespace moonbasepp {
         if (m_licensingInfo.offlineActivated) { // Can't revoke, so all good..
             return true;
         }
-        const auto now = std::chrono::system_clock::now();
+        const auto now = this->now();
         if (m_licensingInfo.trial) { // this is a trial, so we need to check expiration
             const auto trialExpiration = asJson.at("exp").get<int>();
             const auto expTimePoint = std::chrono::system_clock::from_time_t(trialExpiration);
@@ -131,27 +131,37 @@ namespace moonbasepp {
             }
         }
         const auto lastValidatedAt = asJson.at("validated").get<int>();
-        const auto lastValidatedSecondsSinceEpoch = std::chrono::system_clock::from_time_t(lastValidatedAt);
-        const auto delta = std::chrono::duration_cast<std::chrono::days>(now - lastValidatedSecondsSinceEpoch);
-        return [&]() -> bool {
-            if (delta <= std::chrono::days{ m_context.validationThresholds.allowedDaysWithoutValidation }) {
-                return true;
-            }
-            if (!validate(m_validationUrl, m_expectedLicenseFile, token)) {
-                m_licensingInfo.offlineActivated.store(false);
-                m_licensingInfo.onlineValidationPending.store(true);
-                if (m_context.validationThresholds.gracePeriod) {
-                    const auto withinGracePeriod = delta <= std::chrono::days{ m_context.validationThresholds.gracePeriod.value() };
-                    m_licensingInfo.offlineGracePeriodExceeded.store(!withinGracePeriod);
-                    return withinGracePeriod;
-                }
-            }
-            m_licensingInfo.offlineGracePeriodExceeded.store(false);
+        const auto decision = getValidationDecision(m_context.validationThresholds, std::chrono::system_clock::from_time_t(lastValidatedAt), now);
+        if (!decision.shouldValidate) {
             return true;
-        }();
+        }
+        if (!validate(m_validationUrl, m_expectedLicenseFile, token)) {
+            m_licensingInfo.offlineActivated.store(false);
+            m_licensingInfo.onlineValidationPending.store(true);
+            m_licensingInfo.offlineGracePeriodExceeded.store(!decision.activeIfValidationFails);
+            return decision.activeIfValidationFails;
+        }
+        m_licensingInfo.offlineGracePeriodExceeded.store(false);
+        return true;
+    }
+
+    auto Licensing::getValidationDecision(const ValidationThresholds& thresholds, std::chrono::system_clock::time_point lastValidated, std::chrono::system_clock::time_point now) -> ValidationDecision {
+        const auto delta = std::chrono::duration_cast<std::chrono::days>(now - lastValidated);
+        if (delta <= std::chrono::days{ thresholds.allowedDaysWithoutValidation }) {
+            return { .shouldValidate = false, .activeIfValidationFails = true };
+        }
+        if (!thresholds.gracePeriod) { // No grace period, so never report unlicensed because of a failed validation
+            return { .shouldValidate = true, .activeIfValidationFails = true };
+        }
+        return { .shouldValidate = true, .activeIfValidationFails = delta <= std::chrono::days{ thresholds.gracePeriod.value() } };
+    }
+
+    auto Licensing::now() const -> std::chrono::system_clock::time_point {
+        return m_context.clock ? m_context.clock() : std::chrono::system_clock::now();
     }
 
     auto Licensing::checkForExisting() -> bool {
+        std::scoped_lock lock{ m_licenseFileMutex };
         if (!std::filesystem::exists(m_expectedLicenseFile)) { // no license on disk
             m_licensingInfo.isLicenseActive.store(false);
             return false;
@@ -225,9 +235,10 @@ namespace moonbasepp {
             const auto& body_json = jwt_opt->body;
             m_licensingInfo.trial = body_json["trial"].get<bool>();
             if (m_licensingInfo.trial) {
-                m_licensingInfo.trialDaysRemaining = getTrialDaysRemaining(body_json["exp"].get<int>());
+                m_licensingInfo.trialDaysRemaining = getTrialDaysRemaining(body_json["exp"].get<int>(), now());
             }
 
+            std::scoped_lock lock{ m_licenseFileMutex };
             std::ofstream outStream{ m_expectedLicenseFile, std::ios::out };
             outStream << token;
             outStream.flush();
@@ -240,6 +251,7 @@ namespace moonbasepp {
     }
 
     auto Licensing::deactivate() -> bool {
+        std::scoped_lock lock{ m_licenseFileMutex };
         if (!std::filesystem::exists(m_expectedLicenseFile)) {
             return false;
         }
@@ -288,6 +300,7 @@ namespace moonbasepp {
     }
 
     auto Licensing::receiveOfflineLicenseToken(const std::filesystem::path& licenseToken) -> bool {
+        std::scoped_lock lock{ m_licenseFileMutex };
         std::filesystem::copy(licenseToken, m_expectedLicenseFile);
         m_licensingInfo.isLicenseActive = check(m_expectedLicenseFile);
         return m_licensingInfo.isLicenseActive;
@@ -297,6 +310,7 @@ namespace moonbasepp {
         if (!jwt::decode(data)) {
             return false;
         }
+        std::scoped_lock lock{ m_licenseFileMutex };
         std::ofstream outStream{ m_expectedLicenseFile, std::ios::out };
         outStream << data;
         outStream.flush();
@@ -315,5 +329,9 @@ namespace moonbasepp {
         };
     }
 
+    auto Licensing::getLicenseFile() const -> const std::filesystem::path& {
+        return m_expectedLicenseFile;
+    }
+
 
 } // namespace moonbasepp
\ No newline at end of file
@@ -0,0 +1,269 @@
+//
+// Fleet-scale simulation of online validation load for a given set of ValidationThresholds.
+// Every virtual install runs Licensing::getValidationDecision (the same policy checkForExisting uses) against a simulated clock,
+// so thresholds can be sized before a launch without touching the real API.
+//
+// Usage: moonbasepp-simulator [--installs=200000] [--days=120] [--allowed-days=2] [--grace=30|none] [--rollout-days=14]
+//                             [--outage=<day>:<start hour UTC>:<hours>]... [--seed=1] [--csv]
+//
+
+#include <moonbasepp/moonbasepp_Licensing.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+    using TimePoint = std::chrono::system_clock::time_point;
+
+    struct Outage final {
+        int day;
+        int startHour;
+        int hours;
+    };
+
+    struct SimulationParams final {
+        int installs{ 200000 };
+        int days{ 120 };
+        moonbasepp::Licensing::ValidationThresholds thresholds{ .allowedDaysWithoutValidation = 2, .gracePeriod = 30 };
+        /// Activations are spread over roughly this many days after launch, front loaded
+        int rolloutDays{ 14 };
+        std::vector<Outage> outages;
+        std::uint64_t seed{ 1 };
+        bool csv{ false };
+    };
+
+    /// How often a user opens their DAW - chance of at least one session on a given weekday / weekend day
+    struct UsageProfile final {
+        std::string_view name;
+        double weight;
+        double weekdayChance;
+        double weekendChance;
+    };
+
+    constexpr std::array s_profiles{
+        UsageProfile{ .name = "daily", .weight = 0.35, .weekdayChance = 0.85, .weekendChance = 0.5 },
+        UsageProfile{ .name = "workweek", .weight = 0.25, .weekdayChance = 0.9, .weekendChance = 0.05 },
+        UsageProfile{ .name = "weekly", .weight = 0.25, .weekdayChance = 0.15, .weekendChance = 0.3 },
+        UsageProfile{ .name = "dormant", .weight = 0.15, .weekdayChance = 0.02, .weekendChance = 0.02 },
+    };
+
+    /// Relative likelihood of a session starting in each local hour - a late morning bump, and a bigger evening one
+    constexpr std::array<double, 24> s_localHourWeights{
+        1, 0.6, 0.3, 0.2, 0.1, 0.1, 0.2, 0.5, 1, 2, 3, 3.5, 3, 3, 3, 3, 3, 3.5, 4.5, 6, 6.5, 6, 4, 2
+    };
+
+    struct Install final {
+        TimePoint activatedAt;
+        TimePoint lastValidated;
+        std::size_t profile;
+        int utcOffsetHours;
+    };
+
+    struct Results final {
+        std::vector<std::uint64_t> requestsPerHour;
+        std::vector<std::uint64_t> failedRequestsPerHour;
+        std::uint64_t sessions{ 0 };
+        std::uint64_t checks{ 0 };
+        std::uint64_t lockedOutSessions{ 0 };
+        std::uint64_t lockedOutInstalls{ 0 };
+    };
+
+    auto parseArgs(int argc, char** argv, SimulationParams& params) -> bool {
+        for (auto i = 1; i < argc; ++i) {
+            const std::string_view arg{ argv[i] };
+            const auto separator = arg.find('=');
+            const auto key = arg.substr(0, separator);
+            const auto value = separator == std::string_view::npos ? std::string{} : std::string{ arg.substr(separator + 1) };
+            try {
+                if (key == "--installs") {
+                    params.installs = std::stoi(value);
+                } else if (key == "--days") {
+                    params.days = std::stoi(value);
+                } else if (key == "--allowed-days") {
+                    params.thresholds.allowedDaysWithoutValidation = std::stoi(value);
+                } else if (key == "--grace") {
+                    params.thresholds.gracePeriod = value == "none" ? std::nullopt : std::optional<int>{ std::stoi(value) };
+                } else if (key == "--rollout-days") {
+                    params.rolloutDays = std::max(std::stoi(value), 1);
+                } else if (key == "--outage") {
+                    Outage outage{};
+                    char colon1{}, colon2{};
+                    std::istringstream stream{ value };
+                    if (!(stream >> outage.day >> colon1 >> outage.startHour >> colon2 >> outage.hours) || colon1 != ':' || colon2 != ':') {
+                        return false;
+                    }
+                    params.outages.emplace_back(outage);
+                } else if (key == "--seed") {
+                    params.seed = std::stoull(value);
+                } else if (key == "--csv") {
+                    params.csv = true;
+                } else {
+                    return false;
+                }
+            } catch (...) {
+                return false;
+            }
+        }
+        return params.installs > 0 && params.days > 0;
+    }
+
+    auto simulate(const SimulationParams& params) -> Results {
+        using namespace std::chrono;
+        const auto start = TimePoint{ sys_days{ year{ 2026 } / January / 1 } };
+        const auto numHours = static_cast<std::size_t>(params.days) * 24;
+        Results results{ .requestsPerHour = std::vector<std::uint64_t>(numHours, 0), .failedRequestsPerHour = std::vector<std::uint64_t>(numHours, 0) };
+
+        std::vector<bool> isApiDown(numHours, false);
+        for (const auto& outage : params.outages) {
+            for (auto hour = outage.day * 24 + outage.startHour; hour < outage.day * 24 + outage.startHour + outage.hours; ++hour) {
+                if (hour >= 0 && static_cast<std::size_t>(hour) < numHours) {
+                    isApiDown[hour] = true;
+                }
+            }
+        }
+
+        std::mt19937_64 rng{ params.seed };
+        std::array<double, s_profiles.size()> profileWeights{};
+        std::transform(s_profiles.begin(), s_profiles.end(), profileWeights.begin(), [](const UsageProfile& p) -> double { return p.weight; });
+        std::discrete_distribution<std::size_t> profileDist{ profileWeights.begin(), profileWeights.end() };
+        std::discrete_distribution<int> localHourDist{ s_localHourWeights.begin(), s_localHourWeights.end() };
+        // Most of the audience is spread across the Americas and Europe
+        std::discrete_distribution<int> utcOffsetDist{ { 1.0, 3.0, 2.0, 4.0, 1.0, 0.5, 3.0, 4.0, 2.0, 0.5, 0.5, 1.0 } };
+        constexpr std::array s_utcOffsets{ -10, -8, -7, -5, -3, 0, 1, 2, 3, 5, 8, 10 };
+        std::exponential_distribution<double> activationDayDist{ 3.0 / params.rolloutDays };
+        std::uniform_real_distribution<double> unitDist{ 0.0, 1.0 };
+        std::uniform_int_distribution<int> secondDist{ 0, 3599 };
+        // Sessions per active day, and plugin instances per session - every instance runs its own check
+        std::geometric_distribution<int> extraSessionsDist{ 0.6 };
+        std::uniform_int_distribution<int> instancesDist{ 1, 6 };
+
+        struct Session final {
+            TimePoint at;
+            int instances;
+        };
+        std::vector<Session> sessions;
+        for (auto i = 0; i < params.installs; ++i) {
+            const auto activationDay = std::min(activationDayDist(rng), static_cast<double>(params.days));
+            const auto activatedAt = start + duration_cast<seconds>(duration<double, days::period>{ activationDay });
+            Install install{ .activatedAt = activatedAt, .lastValidated = activatedAt, .profile = profileDist(rng), .utcOffsetHours = s_utcOffsets[utcOffsetDist(rng)] };
+            const auto& profile = s_profiles[install.profile];
+            auto isLockedOut{ false };
+            for (auto day = static_cast<int>(activationDay); day < params.days; ++day) {
+                const auto dayStart = start + days{ day };
+                const weekday weekday{ floor<days>(dayStart) };
+                const auto isWeekend = weekday == Saturday || weekday == Sunday;
+                if (unitDist(rng) >= (isWeekend ? profile.weekendChance : profile.weekdayChance)) {
+                    continue;
+                }
+                sessions.clear();
+                const auto numSessions = 1 + extraSessionsDist(rng);
+                for (auto s = 0; s < numSessions; ++s) {
+                    const auto utcHour = localHourDist(rng) - install.utcOffsetHours;
+                    const auto at = dayStart + hours{ utcHour } + seconds{ secondDist(rng) };
+                    if (at < install.activatedAt) {
+                        continue;
+                    }
+                    sessions.push_back({ .at = at, .instances = instancesDist(rng) });
+                }
+                std::sort(sessions.begin(), sessions.end(), [](const Session& a, const Session& b) -> bool { return a.at < b.at; });
+                for (const auto& session : sessions) {
+                    const auto hourIndex = duration_cast<hours>(session.at - start).count();
+                    if (hourIndex < 0 || static_cast<std::size_t>(hourIndex) >= numHours) {
+                        continue;
+                    }
+                    ++results.sessions;
+                    auto isSessionActive{ true };
+                    for (auto instance = 0; instance < session.instances; ++instance) {
+                        ++results.checks;
+                        const auto decision = moonbasepp::Licensing::getValidationDecision(params.thresholds, install.lastValidated, session.at);
+                        if (!decision.shouldValidate) {
+                            continue;
+                        }
+                        ++results.requestsPerHour[hourIndex];
+                        if (!isApiDown[hourIndex]) { // the refreshed token is written to disk, so the remaining instances skip validation
+                            install.lastValidated = session.at;
+                            isSessionActive = true;
+                            continue;
+                        }
+                        ++results.failedRequestsPerHour[hourIndex];
+                        isSessionActive = decision.activeIfValidationFails;
+                    }
+                    if (!isSessionActive) {
+                        ++results.lockedOutSessions;
+                        isLockedOut = true;
+                    }
+                }
+            }
+            results.lockedOutInstalls += isLockedOut ? 1 : 0;
+        }
+        return results;
+    }
+
+    auto report(const SimulationParams& params, const Results& results, double elapsedSeconds) -> void {
+        std::vector<std::uint64_t> requestsPerDay(params.days, 0);
+        std::vector<std::uint64_t> failedPerDay(params.days, 0);
+        std::vector<std::uint64_t> peakHourPerDay(params.days, 0);
+        for (std::size_t hour = 0; hour < results.requestsPerHour.size(); ++hour) {
+            requestsPerDay[hour / 24] += results.requestsPerHour[hour];
+            failedPerDay[hour / 24] += results.failedRequestsPerHour[hour];
+            peakHourPerDay[hour / 24] = std::max(peakHourPerDay[hour / 24], results.requestsPerHour[hour]);
+        }
+        if (params.csv) {
+            std::cout << "day,requests,failed_requests,peak_hour_requests\n";
+            for (auto day = 0; day < params.days; ++day) {
+                std::cout << day << "," << requestsPerDay[day] << "," << failedPerDay[day] << "," << peakHourPerDay[day] << "\n";
+            }
+            return;
+        }
+        std::uint64_t totalRequests{ 0 }, totalFailed{ 0 };
+        for (auto day = 0; day < params.days; ++day) {
+            totalRequests += requestsPerDay[day];
+            totalFailed += failedPerDay[day];
+        }
+        const auto peakDay = std::distance(requestsPerDay.begin(), std::max_element(requestsPerDay.begin(), requestsPerDay.end()));
+        const auto peakHour = std::distance(results.requestsPerHour.begin(), std::max_element(results.requestsPerHour.begin(), results.requestsPerHour.end()));
+        // Steady state - the last 28 days, well after the launch spike
+        const auto steadyStart = std::max(0, params.days - 28);
+        std::uint64_t steadyRequests{ 0 };
+        for (auto day = steadyStart; day < params.days; ++day) {
+            steadyRequests += requestsPerDay[day];
+        }
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << "installs:                " << params.installs << " over " << params.days << " simulated days (" << elapsedSeconds << "s)\n"
+                  << "thresholds:              allowedDaysWithoutValidation=" << params.thresholds.allowedDaysWithoutValidation
+                  << ", gracePeriod=" << (params.thresholds.gracePeriod ? std::to_string(*params.thresholds.gracePeriod) : "none") << "\n"
+                  << "sessions / checks:       " << results.sessions << " / " << results.checks << "\n"
+                  << "validation requests:     " << totalRequests << " (" << totalFailed << " failed during outages)\n"
+                  << "requests/day mean:       " << static_cast<double>(totalRequests) / params.days << "\n"
+                  << "requests/day steady:     " << static_cast<double>(steadyRequests) / (params.days - steadyStart) << " (last " << params.days - steadyStart << " days)\n"
+                  << "busiest day:             day " << peakDay << " - " << requestsPerDay[peakDay] << " requests\n"
+                  << "peak hour:               day " << peakHour / 24 << ", " << std::setw(2) << std::setfill('0') << peakHour % 24 << ":00 UTC - "
+                  << results.requestsPerHour[peakHour] << " requests (" << static_cast<double>(results.requestsPerHour[peakHour]) / 3600.0 << " req/s)\n"
+                  << "locked out sessions:     " << results.lockedOutSessions << " across " << results.lockedOutInstalls << " installs\n";
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    SimulationParams params;
+    if (!parseArgs(argc, argv, params)) {
+        std::cerr << "Usage: moonbasepp-simulator [--installs=200000] [--days=120] [--allowed-days=2] [--grace=30|none] [--rollout-days=14]\n"
+                     "                            [--outage=<day>:<start hour UTC>:<hours>]... [--seed=1] [--csv]\n";
+        return 1;
+    }
+    const auto startedAt = std::chrono::steady_clock::now();
+    const auto results = simulate(params);
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startedAt).count();
+    report(params, results, elapsed);
+    return 0;
+}
@@ -0,0 +1,418 @@
+//
+// Bulk verification of license tokens (.mb) and offline device requests (.dt), for support & audit tooling.
+// Inputs can be directories (searched recursively for .mb / .dt files), individual .mb / .dt files, newline-delimited files of
+// tokens / requests, or - for stdin. Tokens are verified on a work-stealing thread pool, with one parsed key per worker,
+// and results are written to stdout as JSON Lines, in completion order. A summary is written to stderr.
+//
+// Usage: moonbasepp-verify --key=<public key, PEM or DER> [--product=<product id>] [--fingerprint=<device signature>]
+//                          [--threads=<n>] <directory|file|->...
+//
+
+#include <moonbasepp/moonbasepp_DeviceFingerprint.h>
+#include <moonbasepp/moonbasepp_JWT.h>
+#include <cpp-base64/base64.h>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct Options final {
+        std::string key;
+        std::optional<std::string> productId;
+        std::optional<moonbasepp::DeviceFingerprint> fingerprint;
+        std::size_t numThreads{ std::max(std::thread::hardware_concurrency(), 1u) };
+        std::vector<std::string> inputs;
+    };
+
+    /// Either a file to read, or a token / request read from a newline-delimited list
+    struct Task final {
+        std::string source;
+        std::filesystem::path file;
+        std::string contents;
+    };
+
+    struct Counts final {
+        std::atomic<std::uint64_t> total{ 0 };
+        std::atomic<std::uint64_t> ok{ 0 };
+    };
+
+    auto readFile(const std::filesystem::path& path) -> std::optional<std::string> {
+        std::ifstream inStream{ path, std::ios::in | std::ios::binary };
+        if (!inStream) {
+            return {};
+        }
+        return std::string{ std::istreambuf_iterator<char>(inStream), std::istreambuf_iterator<char>() };
+    }
+
+    auto trim(std::string_view str) -> std::string_view {
+        constexpr std::string_view whitespace{ " \t\r\n" };
+        const auto start = str.find_first_not_of(whitespace);
+        if (start == std::string_view::npos) {
+            return {};
+        }
+        return str.substr(start, str.find_last_not_of(whitespace) - start + 1);
+    }
+
+    auto parseKey(const std::string& key) -> std::optional<moonbasepp::jwt::PublicKey> {
+        if (key.starts_with("-----BEGIN")) {
+            return moonbasepp::jwt::PublicKey::fromPem(key);
+        }
+        return moonbasepp::jwt::PublicKey::fromDer({ reinterpret_cast<const unsigned char*>(key.data()), key.size() });
+    }
+
+    /// A worker's deque - the owner pops from the back, thieves steal from the front
+    class WorkQueue final {
+    public:
+        auto push(Task task) -> void {
+            std::scoped_lock sl{ m_mutex };
+            m_tasks.emplace_back(std::move(task));
+        }
+
+        auto pop() -> std::optional<Task> {
+            std::scoped_lock sl{ m_mutex };
+            if (m_tasks.empty()) {
+                return {};
+            }
+            auto res = std::move(m_tasks.back());
+            m_tasks.pop_back();
+            return res;
+        }
+
+        auto steal() -> std::optional<Task> {
+            std::scoped_lock sl{ m_mutex };
+            if (m_tasks.empty()) {
+                return {};
+            }
+            auto res = std::move(m_tasks.front());
+            m_tasks.pop_front();
+            return res;
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::deque<Task> m_tasks;
+    };
+
+    class Verifier final {
+    public:
+        explicit Verifier(const Options& options) : m_options(options),
+                                                    m_queues(options.numThreads),
+                                                    m_maxQueued(options.numThreads * 256) {
+        }
+
+        ~Verifier() noexcept {
+            finish();
+        }
+
+        /// Parses one key per worker up front, so a bad key fails before anything is queued
+        [[nodiscard]] auto start() -> bool {
+            std::vector<moonbasepp::jwt::PublicKey> keys;
+            for (std::size_t i = 0; i < m_options.numThreads; ++i) {
+                auto key = parseKey(m_options.key);
+                if (!key) {
+                    return false;
+                }
+                keys.emplace_back(std::move(*key));
+            }
+            for (std::size_t i = 0; i < m_options.numThreads; ++i) {
+                m_workers.emplace_back([this, i, key = std::move(keys[i])]() mutable -> void { runWorker(i, key); });
+            }
+            return true;
+        }
+
+        // [[ Producer Thread ]]
+        auto submit(Task task) -> void {
+            {
+                std::unique_lock lock{ m_mutex };
+                m_spaceAvailable.wait(lock, [this]() -> bool { return m_numQueued < m_maxQueued; });
+                ++m_numQueued;
+            }
+            m_queues[m_nextQueue].push(std::move(task));
+            m_nextQueue = (m_nextQueue + 1) % m_queues.size();
+            m_workAvailable.notify_one();
+        }
+
+        auto finish() -> void {
+            {
+                std::scoped_lock sl{ m_mutex };
+                m_isProducerDone = true;
+            }
+            m_workAvailable.notify_all();
+            for (auto& worker : m_workers) {
+                if (worker.joinable()) {
+                    worker.join();
+                }
+            }
+        }
+
+        [[nodiscard]] auto getCounts() const -> const Counts& {
+            return m_counts;
+        }
+
+    private:
+        // [[ Worker Thread ]]
+        auto takeTask(std::size_t index) -> std::optional<Task> {
+            auto task = m_queues[index].pop();
+            for (std::size_t offset = 1; !task && offset < m_queues.size(); ++offset) {
+                task = m_queues[(index + offset) % m_queues.size()].steal();
+            }
+            if (task) {
+                {
+                    std::scoped_lock sl{ m_mutex };
+                    --m_numQueued;
+                }
+                m_spaceAvailable.notify_one();
+            }
+            return task;
+        }
+
+        auto runWorker(std::size_t index, moonbasepp::jwt::PublicKey& key) -> void {
+            std::string output;
+            while (true) {
+                if (auto task = takeTask(index)) {
+                    const auto result = verify(*task, key);
+                    ++m_counts.total;
+                    m_counts.ok += result.at("ok").get<bool>() ? 1 : 0;
+                    // Sources & claims can hold arbitrary bytes - replace invalid UTF-8 rather than throwing (type_error 316)
+                    output += result.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+                    output += '\n';
+                    if (output.size() >= 64 * 1024) {
+                        flush(output);
+                    }
+                    continue;
+                }
+                std::unique_lock lock{ m_mutex };
+                if (m_isProducerDone && m_numQueued == 0) {
+                    break;
+                }
+                m_workAvailable.wait(lock, [this]() -> bool { return m_numQueued > 0 || m_isProducerDone; });
+            }
+            flush(output);
+        }
+
+        auto flush(std::string& output) -> void {
+            std::scoped_lock sl{ m_outputMutex };
+            std::fwrite(output.data(), 1, output.size(), stdout);
+            output.clear();
+        }
+
+        auto checkFingerprint(nlohmann::json& result, const std::string& signature) const -> bool {
+            if (!m_options.fingerprint) {
+                return true;
+            }
+            // compareFingerprint asserts on garbage, so make sure the signature decodes first
+            const auto matches = moonbasepp::fingerprintFromBase64(signature) && moonbasepp::compareFingerprint(*m_options.fingerprint, signature);
+            result["fingerprintMatch"] = matches;
+            return matches;
+        }
+
+        auto checkProduct(nlohmann::json& result, const std::string& productId) const -> bool {
+            result["productId"] = productId;
+            if (!m_options.productId) {
+                return true;
+            }
+            const auto matches = productId == *m_options.productId;
+            result["productMatch"] = matches;
+            return matches;
+        }
+
+        auto verify(const Task& task, moonbasepp::jwt::PublicKey& key) const -> nlohmann::json {
+            nlohmann::json result;
+            result["source"] = task.source;
+            result["ok"] = false;
+            const auto fileContents = task.file.empty() ? std::nullopt : readFile(task.file);
+            if (!task.file.empty() && !fileContents) {
+                result["error"] = "unreadable";
+                return result;
+            }
+            const auto contents = trim(fileContents ? *fileContents : task.contents);
+            // Files say what they are - lines from a list are tokens if they look like a JWT
+            const auto extension = task.file.extension();
+            const auto isDeviceRequest = extension == ".dt" || (extension != ".mb" && std::count(contents.begin(), contents.end(), '.') != 2);
+            try {
+                if (isDeviceRequest) {
+                    result["kind"] = "deviceRequest";
+                    const auto request = nlohmann::json::parse(base64_decode(std::string{ contents }));
+                    result["deviceName"] = request.at("name").get<std::string>();
+                    const auto isProductOk = checkProduct(result, request.at("productId").get<std::string>());
+                    const auto isFingerprintOk = checkFingerprint(result, request.at("id").get<std::string>());
+                    result["ok"] = isProductOk && isFingerprintOk;
+                    return result;
+                }
+                result["kind"] = "license";
+                const auto jwt = moonbasepp::jwt::decode(contents);
+                if (!jwt) {
+                    result["error"] = "malformed";
+                    return result;
+                }
+                const auto isSignatureValid = moonbasepp::jwt::verifySignature(key, *jwt);
+                result["signatureValid"] = isSignatureValid;
+                const auto& body = jwt->body;
+                for (const auto* claim : { "method", "trial", "exp", "validated" }) {
+                    if (body.contains(claim)) {
+                        result[claim] = body.at(claim);
+                    }
+                }
+                // Licensing only enforces exp for trials, but an expired token isn't valid whatever it is
+                auto isExpired{ false };
+                if (body.contains("exp")) {
+                    const auto expiresAt = std::chrono::system_clock::from_time_t(body.at("exp").get<std::int64_t>());
+                    isExpired = expiresAt < std::chrono::system_clock::now();
+                    result["expired"] = isExpired;
+                }
+                const auto isProductOk = checkProduct(result, body.at("p:id").get<std::string>());
+                const auto isFingerprintOk = checkFingerprint(result, body.at("sig").get<std::string>());
+                result["ok"] = isSignatureValid && !isExpired && isProductOk && isFingerprintOk;
+            } catch (...) {
+                result["error"] = "malformed";
+            }
+            return result;
+        }
+
+        const Options& m_options;
+        std::vector<WorkQueue> m_queues;
+        std::size_t m_nextQueue{ 0 };
+        const std::size_t m_maxQueued;
+        std::mutex m_mutex;
+        std::condition_variable m_workAvailable;
+        std::condition_variable m_spaceAvailable;
+        std::size_t m_numQueued{ 0 };
+        bool m_isProducerDone{ false };
+        std::mutex m_outputMutex;
+        Counts m_counts;
+        std::vector<std::thread> m_workers;
+    };
+
+    auto parseArgs(int argc, char** argv, Options& options) -> bool {
+        for (auto i = 1; i < argc; ++i) {
+            const std::string_view arg{ argv[i] };
+            if (!arg.starts_with("--") || arg == "-") {
+                options.inputs.emplace_back(arg);
+                continue;
+            }
+            const auto separator = arg.find('=');
+            if (separator == std::string_view::npos) {
+                return false;
+            }
+            const auto key = arg.substr(0, separator);
+            const std::string value{ arg.substr(separator + 1) };
+            if (key == "--key") {
+                auto contents = readFile(value);
+                if (!contents) {
+                    std::cerr << "Couldn't read key file " << value << "\n";
+                    return false;
+                }
+                options.key = std::move(*contents);
+            } else if (key == "--product") {
+                options.productId = value;
+            } else if (key == "--fingerprint") {
+                options.fingerprint = moonbasepp::fingerprintFromBase64(value);
+                if (!options.fingerprint) {
+                    std::cerr << "Invalid device signature " << value << "\n";
+                    return false;
+                }
+            } else if (key == "--threads") {
+                try {
+                    options.numThreads = std::max(std::stoi(value), 1);
+                } catch (...) {
+                    return false;
+                }
+            } else {
+                return false;
+            }
+        }
+        return !options.key.empty() && !options.inputs.empty();
+    }
+
+    auto submitLines(Verifier& verifier, std::istream& stream, const std::string& source) -> void {
+        std::string line;
+        for (auto lineNumber = 1; std::getline(stream, line); ++lineNumber) {
+            if (trim(line).empty()) {
+                continue;
+            }
+            verifier.submit({ .source = source + ":" + std::to_string(lineNumber), .file = {}, .contents = std::move(line) });
+        }
+    }
+
+    auto isTokenFile(const std::filesystem::path& path) -> bool {
+        const auto extension = path.extension();
+        return extension == ".mb" || extension == ".dt";
+    }
+
+    auto submitInput(Verifier& verifier, const std::string& input) -> bool {
+        if (input == "-") {
+            submitLines(verifier, std::cin, "stdin");
+            return true;
+        }
+        std::error_code ec;
+        if (std::filesystem::is_directory(input, ec)) {
+            for (auto it = std::filesystem::recursive_directory_iterator{ input, std::filesystem::directory_options::skip_permission_denied, ec };
+                 !ec && it != std::filesystem::recursive_directory_iterator{};
+                 it.increment(ec)) {
+                if (it->is_regular_file(ec) && isTokenFile(it->path())) {
+                    verifier.submit({ .source = it->path().string(), .file = it->path(), .contents = {} });
+                }
+            }
+            return !ec;
+        }
+        if (isTokenFile(input)) {
+            verifier.submit({ .source = input, .file = input, .contents = {} });
+            return true;
+        }
+        std::ifstream inStream{ input, std::ios::in };
+        if (!inStream) {
+            return false;
+        }
+        submitLines(verifier, inStream, input);
+        return true;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseArgs(argc, argv, options)) {
+        std::cerr << "Usage: moonbasepp-verify --key=<public key, PEM or DER> [--product=<product id>] [--fingerprint=<device signature>]\n"
+                     "                         [--threads=<n>] <directory|file|->...\n";
+        return 1;
+    }
+    const auto startedAt = std::chrono::steady_clock::now();
+    Verifier verifier{ options };
+    if (!verifier.start()) {
+        std::cerr << "Couldn't parse the public key\n";
+        return 1;
+    }
+    auto areInputsOk{ true };
+    for (const auto& input : options.inputs) {
+        if (!submitInput(verifier, input)) {
+            std::cerr << "Couldn't read " << input << "\n";
+            areInputsOk = false;
+        }
+    }
+    verifier.finish();
+    std::fflush(stdout);
+
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startedAt).count();
+    const auto& counts = verifier.getCounts();
+    std::cerr << counts.total << " checked, " << counts.ok << " ok, " << counts.total - counts.ok << " failed in " << elapsed << "s ("
+              << static_cast<double>(counts.total) / std::max(elapsed, 1e-9) * 60.0 << " per minute, " << options.numThreads << " threads)\n";
+    if (!areInputsOk) {
+        return 1;
+    }
+    return counts.ok == counts.total ? 0 : 2;
+}